@@ -1,8 +1,52 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <shared_mutex>
+#include <span>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <list>
+#include <map>
+
+#include <fcntl.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace InventorySystem {
 
@@ -10,34 +54,288 @@ namespace InventorySystem {
     template <typename ItemType, typename LocationType>
     class WarehouseInventory;
 
-    template <typename ItemType, template <typename> class DataContainer>
+    template <typename ItemType, template <typename> class DataContainer, typename Index>
     class Catalog;
 
+    // Default Catalog index: keeps nothing, so find() walks the container.
+    struct NoIndex {
+        template <typename Container, typename Item>
+        void insert(Container const &, Item const &, size_t) {}
+
+        template <typename Container>
+        void reserve(Container const &, size_t) {}
+
+        template <typename Container, typename Item>
+        std::optional<size_t> find(Container const &container, Item const &item) const {
+            size_t position = 0;
+            for (auto const &candidate : container) {
+                if (candidate == item) {
+                    return position;
+                }
+                ++position;
+            }
+            return std::nullopt;
+        }
+    };
+
+    // Open-addressing hash index in the style of a Swiss table. Each slot
+    // has a control byte (empty, or 7 bits of the item's hash) and the
+    // item's position in the catalog. A lookup compares 16 control bytes at
+    // once with SSE2 and only visits the container for matching candidates,
+    // so it is O(1) for random-access containers. Duplicate items keep the
+    // position of their first occurrence.
+    template <typename ItemType, typename Hash = std::hash<ItemType>>
+    class SwissIndex {
+        static constexpr size_t kGroupWidth = 16;
+        static constexpr int8_t kEmpty = -128;
+
+        std::vector<int8_t> control_;
+        std::vector<uint32_t> positions_;
+        size_t group_mask_ = 0;
+        size_t count_ = 0;
+        [[no_unique_address]] Hash hash_;
+
+        // std::hash is the identity for integers; spread the bits so that
+        // both the group choice and the 7-bit tag are well mixed.
+        size_t HashOf(ItemType const &item) const {
+            uint64_t h = static_cast<uint64_t>(hash_(item));
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return static_cast<size_t>(h);
+        }
+
+        static int8_t TagOf(size_t hash) { return static_cast<int8_t>(hash & 0x7f); }
+
+        // Bit i is set when control byte i of the group equals tag.
+        static uint32_t MatchGroup(int8_t const *group, int8_t tag) {
+#if defined(__SSE2__)
+            __m128i const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(group));
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(tag))));
+#else
+            uint32_t mask = 0;
+            for (size_t i = 0; i < kGroupWidth; ++i) {
+                mask |= static_cast<uint32_t>(group[i] == tag) << i;
+            }
+            return mask;
+#endif
+        }
+
+        // Visits groups in triangular order, which reaches every group when
+        // the group count is a power of two.
+        template <typename Visit>
+        void Probe(size_t hash, Visit &&visit) const {
+            size_t group = (hash >> 7) & group_mask_;
+            for (size_t step = 1;; ++step) {
+                if (visit(group * kGroupWidth)) {
+                    return;
+                }
+                group = (group + step) & group_mask_;
+            }
+        }
+
+        void Place(size_t hash, uint32_t position) {
+            Probe(hash, [&](size_t base) {
+                uint32_t const empty = MatchGroup(&control_[base], kEmpty);
+                if (empty == 0) {
+                    return false;
+                }
+                size_t const slot = base + std::countr_zero(empty);
+                control_[slot] = TagOf(hash);
+                positions_[slot] = position;
+                return true;
+            });
+        }
+
+        // Rebuilds the table for at least n items by walking the container.
+        template <typename Container>
+        void Rehash(Container const &container, size_t n) {
+            size_t groups = 1;
+            while (groups * kGroupWidth * 7 / 8 < n) {
+                groups *= 2;
+            }
+            control_.assign(groups * kGroupWidth, kEmpty);
+            positions_.assign(groups * kGroupWidth, 0);
+            group_mask_ = groups - 1;
+            count_ = 0;
+
+            uint32_t position = 0;
+            for (auto const &item : container) {
+                if (!find(container, item)) {
+                    Place(HashOf(item), position);
+                    ++count_;
+                }
+                ++position;
+            }
+        }
+
+    public:
+        // Records that item sits at position, which must be the container's
+        // next free position.
+        template <typename Container>
+        void insert(Container const &container, ItemType const &item, size_t position) {
+            if (position > UINT32_MAX) {
+                throw std::length_error("SwissIndex: more items than 32-bit positions");
+            }
+            if (control_.empty() || (count_ + 1) > control_.size() * 7 / 8) {
+                Rehash(container, std::max<size_t>(2 * count_, kGroupWidth));
+            }
+            if (find(container, item)) {
+                return;
+            }
+            Place(HashOf(item), static_cast<uint32_t>(position));
+            ++count_;
+        }
+
+        template <typename Container>
+        void reserve(Container const &container, size_t n) {
+            if (n > control_.size() * 7 / 8) {
+                Rehash(container, n);
+            }
+        }
+
+        template <typename Container>
+        std::optional<size_t> find(Container const &container, ItemType const &item) const {
+            if (control_.empty()) {
+                return std::nullopt;
+            }
+
+            size_t const hash = HashOf(item);
+            int8_t const tag = TagOf(hash);
+            std::optional<size_t> result;
+            Probe(hash, [&](size_t base) {
+                for (uint32_t match = MatchGroup(&control_[base], tag); match != 0; match &= match - 1) {
+                    uint32_t const position = positions_[base + std::countr_zero(match)];
+                    if (container[position] == item) {
+                        result = position;
+                        return true;
+                    }
+                }
+                return MatchGroup(&control_[base], kEmpty) != 0;
+            });
+            return result;
+        }
+    };
+
     // Catalog: Records different items in various warehouses (the location).
-    // Catalog should accept any type of data container.
-    template <typename ItemType = std::string, template <typename X = std::string> class DataContainer = std::vector>
+    // Catalog should accept any type of data container. An optional Index
+    // (such as SwissIndex) is kept in sync by add_item and answers find().
+    template <typename ItemType = std::string, template <typename X = std::string> class DataContainer = std::vector,
+              typename Index = NoIndex>
     class Catalog {
     public:
         using Item = ItemType;
         using Container = DataContainer<ItemType>;
 
         Container item_list_;
+        [[no_unique_address]] Index index_;
         Catalog() {};
 
+        // Builds the container with alloc, e.g. a std::pmr::polymorphic_allocator
+        // for Catalog<std::pmr::string, PmrVector>.
+        template <typename Allocator>
+        requires std::constructible_from<Container, Allocator const &>
+        explicit Catalog(Allocator const &alloc) : item_list_(alloc) {}
+
         void add_item(ItemType const &item) {
             item_list_.push_back(item);
+            IndexLast();
+        }
+
+        void add_item(ItemType &&item) {
+            item_list_.push_back(std::move(item));
+            IndexLast();
+        }
+
+        // Constructs the item in place when the container supports it.
+        template <typename... Args>
+        void emplace_item(Args &&...args) {
+            if constexpr (!std::is_same_v<Index, NoIndex>) {
+                // The index needs the item before it is stored.
+                add_item(ItemType(std::forward<Args>(args)...));
+            } else if constexpr (requires { item_list_.emplace_back(std::forward<Args>(args)...); }) {
+                item_list_.emplace_back(std::forward<Args>(args)...);
+            } else {
+                item_list_.push_back(ItemType(std::forward<Args>(args)...));
+            }
+        }
+
+        // Preallocates room for n items; a no-op for containers without reserve.
+        void reserve(size_t n) {
+            if constexpr (requires { item_list_.reserve(n); }) {
+                item_list_.reserve(n);
+            }
+            index_.reserve(item_list_, n);
+        }
+
+        // Position of the first occurrence of item.
+        std::optional<size_t> find(ItemType const &item) const {
+            return index_.find(item_list_, item);
         }
 
         ItemType getItemAt(size_t i) const { return item_list_[i]; }
 
+        // Read access without copying the item when the container hands out
+        // references; containers whose operator[] returns by value (a linked
+        // list, std::vector<bool>) still return by value here.
+        decltype(auto) operator[](size_t i) const { return item_list_[i]; }
+
+        auto begin() const { return std::begin(item_list_); }
+        auto end() const { return std::end(item_list_); }
+
+        // All items as one span, for containers that store them contiguously.
+        std::span<ItemType const> items() const requires std::ranges::contiguous_range<Container const> {
+            return {std::ranges::data(item_list_), std::ranges::size(item_list_)};
+        }
+
         size_t size() const { return item_list_.size(); }
 
         ~Catalog() = default;
+
+    private:
+        // Indexes the item just pushed, so a failed push never leaves the
+        // index pointing past the end. If the index throws, the item is
+        // popped again where the container allows it.
+        void IndexLast() {
+            size_t const position = item_list_.size() - 1;
+            try {
+                index_.insert(item_list_, item_list_[position], position);
+            } catch (...) {
+                if constexpr (requires { item_list_.pop_back(); }) {
+                    item_list_.pop_back();
+                }
+                throw;
+            }
+        }
+    };
+
+    // std::pmr::vector as a Catalog DataContainer.
+    template <typename T>
+    using PmrVector = std::pmr::vector<T>;
+
+    // True when a record member can take a std::pmr allocator.
+    template <typename T>
+    inline constexpr bool kUsesPmrAllocator = std::uses_allocator_v<T, std::pmr::polymorphic_allocator<>>;
+
+    // Declares allocator_type only for records with a pmr member, so
+    // std::uses_allocator stays false for the others.
+    template <bool UsesPmr>
+    struct PmrAllocatorType {};
+
+    template <>
+    struct PmrAllocatorType<true> {
+        using allocator_type = std::pmr::polymorphic_allocator<>;
     };
 
     // Represents the stock of a specific type of item.
+    // When Item or Location is a pmr type, the allocator-extended
+    // constructors let a std::pmr container build records whose members
+    // draw from the container's memory resource.
     template <typename ItemType = std::string, typename LocationType = std::string>
-    class WarehouseInventory {
+    class WarehouseInventory : public PmrAllocatorType<kUsesPmrAllocator<ItemType> || kUsesPmrAllocator<LocationType>> {
+        static constexpr bool kPmr = kUsesPmrAllocator<ItemType> || kUsesPmrAllocator<LocationType>;
+        using PmrAllocator = std::pmr::polymorphic_allocator<>;
+
     public:
         using Item = ItemType;
         using Location = LocationType;
@@ -50,6 +348,26 @@ namespace InventorySystem {
         WarehouseInventory(Item const &item, Location const &location)
             : item_name_(item), location_(location) {}
 
+        WarehouseInventory(WarehouseInventory const &) = default;
+        WarehouseInventory(WarehouseInventory &&) = default;
+        WarehouseInventory &operator=(WarehouseInventory const &) = default;
+        WarehouseInventory &operator=(WarehouseInventory &&) = default;
+
+        WarehouseInventory(std::allocator_arg_t, PmrAllocator const &alloc) requires kPmr
+            : item_name_(std::make_obj_using_allocator<Item>(alloc)), location_(std::make_obj_using_allocator<Location>(alloc)) {}
+
+        template <typename ItemArg, typename LocationArg>
+        requires kPmr
+        WarehouseInventory(std::allocator_arg_t, PmrAllocator const &alloc, ItemArg &&item, LocationArg &&location)
+            : item_name_(std::make_obj_using_allocator<Item>(alloc, std::forward<ItemArg>(item))),
+              location_(std::make_obj_using_allocator<Location>(alloc, std::forward<LocationArg>(location))) {}
+
+        WarehouseInventory(std::allocator_arg_t, PmrAllocator const &alloc, WarehouseInventory const &other) requires kPmr
+            : WarehouseInventory(std::allocator_arg, alloc, other.item_name_, other.location_) {}
+
+        WarehouseInventory(std::allocator_arg_t, PmrAllocator const &alloc, WarehouseInventory &&other) requires kPmr
+            : WarehouseInventory(std::allocator_arg, alloc, std::move(other.item_name_), std::move(other.location_)) {}
+
         // Returns the item name.
         Item getItemName() const { return item_name_; }
 
@@ -69,6 +387,9 @@ namespace InventorySystem {
         }
     };
 
+    // Records whose strings live in a std::pmr memory resource.
+    using PmrWarehouseInventory = WarehouseInventory<std::pmr::string, std::pmr::string>;
+
     // Specialized Warehouse for electronics.
     template <typename LocationType>
     class WarehouseInventory<std::pair<std::string, float>, LocationType> {
@@ -94,152 +415,3389 @@ namespace InventorySystem {
         }
     };
 
-    // Helper function to create some inventories.
-    template <typename ItemType, typename LocationType>
-    WarehouseInventory<ItemType, LocationType> CreateWarehouseItem(const ItemType &item, const LocationType &location) {
-        return {item, location};
-    }
-} // end of namespace InventorySystem
+    // Segmented array: elements live in fixed-size blocks reached through an
+    // index table. operator[] is a shift and a mask, growing only appends a
+    // block (no element is ever moved, so addresses stay stable), and the
+    // only reallocation is of the small table of block pointers.
+    // Usable as Catalog<Item, ChunkedDataContainer>.
+    template <typename T, size_t BlockSize = 1024>
+    class ChunkedDataContainer {
+        static_assert(BlockSize > 0 && (BlockSize & (BlockSize - 1)) == 0, "BlockSize must be a power of two");
 
-namespace Tests {
-    template <typename T>
-    struct LinkedListDataContainer {
-        std::list<T> linked_list_;
+        static constexpr size_t kShift = std::countr_zero(BlockSize);
+        static constexpr size_t kMask = BlockSize - 1;
 
-        void push_back(T const &x) {
-            linked_list_.push_back(x);
+        struct Block {
+            alignas(T) std::byte storage[sizeof(T) * BlockSize];
+        };
+
+        std::vector<std::unique_ptr<Block>> blocks_;
+        size_t size_ = 0;
+
+        T *slot(size_t i) const {
+            return reinterpret_cast<T *>(blocks_[i >> kShift]->storage) + (i & kMask);
         }
 
-        T operator[](int index) const {
-            auto it = linked_list_.begin();
-            std::advance(it, index);
-            return *it;
+        T *element(size_t i) const { return std::launder(slot(i)); }
+
+        // Makes sure the slot at index size_ exists.
+        void grow() {
+            if ((size_ >> kShift) == blocks_.size()) {
+                blocks_.push_back(std::make_unique_for_overwrite<Block>());
+            }
         }
 
-        size_t size() const {
-            return linked_list_.size();
+        template <bool IsConst>
+        class Iterator {
+            using Owner = std::conditional_t<IsConst, ChunkedDataContainer const, ChunkedDataContainer>;
+
+            Owner *owner_ = nullptr;
+            std::ptrdiff_t index_ = 0;
+
+        public:
+            using iterator_concept = std::random_access_iterator_tag;
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<IsConst, T const *, T *>;
+            using reference = std::conditional_t<IsConst, T const &, T &>;
+
+            Iterator() = default;
+            Iterator(Owner *owner, std::ptrdiff_t index) : owner_(owner), index_(index) {}
+
+            // A mutable iterator converts to a const one.
+            operator Iterator<true>() const requires(!IsConst) { return {owner_, index_}; }
+
+            reference operator*() const { return (*owner_)[index_]; }
+            pointer operator->() const { return &(*owner_)[index_]; }
+            reference operator[](difference_type n) const { return (*owner_)[index_ + n]; }
+
+            Iterator &operator++() { ++index_; return *this; }
+            Iterator operator++(int) { Iterator old = *this; ++index_; return old; }
+            Iterator &operator--() { --index_; return *this; }
+            Iterator operator--(int) { Iterator old = *this; --index_; return old; }
+            Iterator &operator+=(difference_type n) { index_ += n; return *this; }
+            Iterator &operator-=(difference_type n) { index_ -= n; return *this; }
+
+            friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+            friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+            friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+            friend difference_type operator-(Iterator const &a, Iterator const &b) { return a.index_ - b.index_; }
+            friend bool operator==(Iterator const &a, Iterator const &b) { return a.index_ == b.index_; }
+            friend auto operator<=>(Iterator const &a, Iterator const &b) { return a.index_ <=> b.index_; }
+        };
+
+    public:
+        using value_type = T;
+        using size_type = size_t;
+        using reference = T &;
+        using const_reference = T const &;
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        static constexpr size_t block_size = BlockSize;
+
+        ChunkedDataContainer() = default;
+
+        // Delegates first so the destructor cleans up if an element copy throws.
+        ChunkedDataContainer(ChunkedDataContainer const &other) : ChunkedDataContainer() {
+            reserve(other.size_);
+            for (T const &item : other) {
+                push_back(item);
+            }
         }
 
-        ~LinkedListDataContainer() = default;
+        ChunkedDataContainer(ChunkedDataContainer &&other) noexcept
+            : blocks_(std::move(other.blocks_)), size_(std::exchange(other.size_, 0)) {}
+
+        ChunkedDataContainer &operator=(ChunkedDataContainer other) noexcept {
+            clear();
+            blocks_ = std::move(other.blocks_);
+            size_ = std::exchange(other.size_, 0);
+            return *this;
+        }
+
+        ~ChunkedDataContainer() { clear(); }
+
+        template <typename... Args>
+        T &emplace_back(Args &&...args) {
+            grow();
+            T *item = ::new (static_cast<void *>(slot(size_))) T(std::forward<Args>(args)...);
+            ++size_;
+            return *item;
+        }
+
+        void push_back(T const &x) { emplace_back(x); }
+
+        void push_back(T &&x) { emplace_back(std::move(x)); }
+
+        // Allocates blocks up front; never moves existing elements.
+        void reserve(size_t n) {
+            size_t const blocks = (n + BlockSize - 1) >> kShift;
+            blocks_.reserve(blocks);
+            while (blocks_.size() < blocks) {
+                blocks_.push_back(std::make_unique_for_overwrite<Block>());
+            }
+        }
+
+        // Destroys all elements but keeps the blocks for reuse.
+        void clear() {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (size_t i = 0; i < size_; ++i) {
+                    std::destroy_at(element(i));
+                }
+            }
+            size_ = 0;
+        }
+
+        T &operator[](size_t index) { return *element(index); }
+
+        T const &operator[](size_t index) const { return *element(index); }
+
+        size_t size() const { return size_; }
+
+        bool empty() const { return size_ == 0; }
+
+        iterator begin() { return {this, 0}; }
+        iterator end() { return {this, static_cast<std::ptrdiff_t>(size_)}; }
+        const_iterator begin() const { return {this, 0}; }
+        const_iterator end() const { return {this, static_cast<std::ptrdiff_t>(size_)}; }
     };
 
-    void TestCatalog() {
-        // Using default template args
-        InventorySystem::Catalog catalog_default;
+    // Deduplicating string store: every distinct string is copied once into
+    // an append-only arena and gets a dense 32-bit ID. A hash table of IDs
+    // (open addressing, linear probing) maps strings back to their ID.
+    // Views returned by view() stay valid for the interner's lifetime.
+    class StringInterner {
+    public:
+        using Id = uint32_t;
 
-        catalog_default.add_item("Washing machine");
-        catalog_default.add_item("Vacuum cleaner");
+    private:
+        static constexpr size_t kChunkSize = 64 * 1024;
+        static constexpr Id kEmpty = UINT32_MAX;
 
-        static_assert(std::is_same_v<decltype(catalog_default.getItemAt(0)), std::string>, "Item should be string");
+        std::vector<std::unique_ptr<char[]>> chunks_;
+        size_t chunk_used_ = kChunkSize;
+        size_t arena_bytes_ = 0;
+        std::vector<std::string_view> strings_;
+        std::vector<uint32_t> hashes_;
+        std::vector<Id> table_ = std::vector<Id>(1024, kEmpty);
 
-        if (catalog_default.getItemAt(0) == "Washing machine" && catalog_default.getItemAt(1) == "Vacuum cleaner") {
-            std::cout << "Default Catalog Test Passed" << std::endl;
-        } else {
-            throw std::runtime_error("Default Catalog Test failed");
+        static uint32_t Hash(std::string_view s) {
+            uint64_t const h = std::hash<std::string_view>{}(s);
+            return static_cast<uint32_t>(h ^ (h >> 32));
         }
 
-        // Providing ItemType but not Container type: should default to vector
-        InventorySystem::Catalog<int> catalog_int_default_container;
-        catalog_int_default_container.add_item(1);
-        catalog_int_default_container.add_item(2);
+        // The table slot holding s, or the empty slot where it would go.
+        size_t Probe(std::string_view s, uint32_t hash) const {
+            size_t const mask = table_.size() - 1;
+            for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+                Id const id = table_[slot];
+                if (id == kEmpty || (hashes_[id] == hash && strings_[id] == s)) {
+                    return slot;
+                }
+            }
+        }
 
-        if (catalog_int_default_container.getItemAt(0) == 1 && catalog_int_default_container.getItemAt(1) == 2) {
-            std::cout << "Int catalog with default container Passed" << std::endl;
-        } else {
-            throw std::runtime_error("Int catalog with default container FAILED");
+        // Copies s into the arena. A string larger than a chunk gets a chunk
+        // of its own, slotted in before the current one so the fill cursor
+        // keeps pointing into chunks_.back().
+        std::string_view Store(std::string_view s) {
+            if (s.size() > kChunkSize) {
+                auto chunk = std::make_unique_for_overwrite<char[]>(s.size());
+                arena_bytes_ += s.size();
+                char *const data = chunk.get();
+                chunks_.insert(chunks_.empty() ? chunks_.end() : chunks_.end() - 1, std::move(chunk));
+                std::copy(s.begin(), s.end(), data);
+                return {data, s.size()};
+            }
+            if (chunks_.empty() || s.size() > kChunkSize - chunk_used_) {
+                chunks_.push_back(std::make_unique_for_overwrite<char[]>(kChunkSize));
+                arena_bytes_ += kChunkSize;
+                chunk_used_ = 0;
+            }
+            char *const data = chunks_.back().get() + chunk_used_;
+            std::copy(s.begin(), s.end(), data);
+            chunk_used_ += s.size();
+            return {data, s.size()};
         }
 
-        // Providing non-default Container: using a different data Container type (customized Data container type)
-        InventorySystem::Catalog<std::string, LinkedListDataContainer> catalog_with_custom_data_container;
+        void Grow() {
+            std::vector<Id> table(table_.size() * 2, kEmpty);
+            size_t const mask = table.size() - 1;
+            for (Id id = 0; id < strings_.size(); ++id) {
+                size_t slot = hashes_[id] & mask;
+                while (table[slot] != kEmpty) {
+                    slot = (slot + 1) & mask;
+                }
+                table[slot] = id;
+            }
+            table_ = std::move(table);
+        }
 
-        catalog_with_custom_data_container.add_item("Refrigerator");
-        catalog_with_custom_data_container.add_item("Radio");
+    public:
+        // The ID of s, adding it on first sight.
+        Id intern(std::string_view s) {
+            uint32_t const hash = Hash(s);
+            size_t slot = Probe(s, hash);
+            if (table_[slot] != kEmpty) {
+                return table_[slot];
+            }
 
-        if (catalog_with_custom_data_container.getItemAt(0) == "Refrigerator" &&
-            catalog_with_custom_data_container.getItemAt(1) == "Radio") {
-            std::cout << "Custom container Data type Passed" << std::endl;
-        } else {
-            throw std::runtime_error("Custom container type test Failed");
+            if (strings_.size() >= UINT32_MAX - 1) {
+                throw std::length_error("StringInterner: out of 32-bit IDs");
+            }
+            // Keep the load factor under 70%.
+            if ((strings_.size() + 1) * 10 > table_.size() * 7) {
+                Grow();
+                slot = Probe(s, hash);
+            }
+
+            Id const id = static_cast<Id>(strings_.size());
+            strings_.push_back(Store(s));
+            hashes_.push_back(hash);
+            table_[slot] = id;
+            return id;
         }
 
-        // Testing that Data container is independent and items can be different for other datastructure
-        InventorySystem::Catalog<double, LinkedListDataContainer> double_catalog;
-        double_catalog.add_item(1.0);
-        double_catalog.add_item(2.0);
+        // The ID of s if it has been interned.
+        std::optional<Id> find(std::string_view s) const {
+            Id const id = table_[Probe(s, Hash(s))];
+            return id == kEmpty ? std::nullopt : std::optional<Id>(id);
+        }
 
-        if (double_catalog.getItemAt(0) == 1.0 && double_catalog.getItemAt(1) == 2.0) {
-            std::cout << "Independent double linked list Passed" << std::endl;
-        } else {
-            throw std::runtime_error("Independent list failed");
+        std::string_view view(Id id) const { return strings_[id]; }
+
+        // Number of distinct strings.
+        size_t size() const { return strings_.size(); }
+
+        // Bytes held by the arena, the ID table and the hash table.
+        size_t memory_usage() const {
+            return arena_bytes_ + strings_.capacity() * sizeof(std::string_view) +
+                   hashes_.capacity() * sizeof(uint32_t) + table_.capacity() * sizeof(Id);
         }
-    }
+    };
 
-    void TestWarehouseInventory() {
-        // Default creation
-        InventorySystem::WarehouseInventory item1;
+    // Catalog of strings stored as interner IDs. Several catalogs (one per
+    // warehouse, say) can share an interner so a name repeated across them
+    // is stored once. Equality is an integer compare and a scan touches 4
+    // bytes per item.
+    template <template <typename> class DataContainer = std::vector>
+    class InternedCatalog {
+    public:
+        using Id = StringInterner::Id;
 
-        std::cout << "Warehouse Inventory Type: " << typeid(item1).name() << std::endl;
+    private:
+        std::shared_ptr<StringInterner> interner_;
+        Catalog<Id, DataContainer> ids_;
 
-        // Item, Location Default to string: Default creation.
-        auto inventory1 = InventorySystem::CreateWarehouseItem(std::string("Iron"), std::string("Warehouse A"));
-        static_assert(std::is_same_v<decltype(inventory1.getItemName()), std::string>, "Item should be default string");
+    public:
+        InternedCatalog() : interner_(std::make_shared<StringInterner>()) {}
 
-        if (inventory1.getItemName() == "Iron" && inventory1.getLocation() == "Warehouse A") {
-            std::cout << "Inventory Creation, Defaults Pass: " << inventory1.getItemName() << " located at " << inventory1.getLocation() << std::endl;
-        } else {
-            throw std::runtime_error("Inventory Creation, Defaults fail");
+        explicit InternedCatalog(std::shared_ptr<StringInterner> interner) : interner_(std::move(interner)) {}
+
+        Id add_item(std::string_view item) {
+            Id const id = interner_->intern(item);
+            ids_.add_item(id);
+            return id;
         }
 
-        // Non-default parameters but default type for locations
-        InventorySystem::WarehouseInventory<int> inventory2(121, "Warehouse B");
-        static_assert(std::is_same_v<decltype(inventory2.getItemName()), int>, "Item should be int");
+        void reserve(size_t n) { ids_.reserve(n); }
 
-        if (inventory2.getItemName() == 121 && inventory2.getLocation() == "Warehouse B") {
-            std::cout << "Inventory Creation Type parameter, String Location Type Passed: " << inventory2.getItemName() << " located at " << inventory2.getLocation() << std::endl;
-        } else {
-            throw std::runtime_error("Creation with type passed but default string fail");
+        std::string_view getItemAt(size_t i) const { return interner_->view(ids_[i]); }
+
+        std::string_view operator[](size_t i) const { return getItemAt(i); }
+
+        Id getIdAt(size_t i) const { return ids_[i]; }
+
+        // Number of entries equal to item, by comparing IDs only.
+        size_t count(std::string_view item) const {
+            auto const id = interner_->find(item);
+            if (!id) {
+                return 0;
+            }
+            size_t matches = 0;
+            for (Id const entry : ids_) {
+                matches += entry == *id;
+            }
+            return matches;
         }
 
-        // Fully type specification
-        InventorySystem::WarehouseInventory<float, int> inventory3(12.3f, 4345);
+        Catalog<Id, DataContainer> const &ids() const { return ids_; }
 
-        if (inventory3.getItemName() == 12.3f && inventory3.getLocation() == 4345) {
-            std::cout << "Inventory Creation, fully Type Parameters Pass: " << inventory3.getItemName() << " location " << inventory3.getLocation() << std::endl;
-        } else {
-            throw std::runtime_error("Fully Type Inventory creation fails");
+        StringInterner const &interner() const { return *interner_; }
+
+        size_t size() const { return ids_.size(); }
+    };
+
+    // Append-only catalog that many threads can fill at once without a mutex.
+    // add_item builds the item, makes sure the segment for the next free
+    // index exists, claims that index with a compare-and-swap and moves the
+    // item into it; segments double in size and are never reallocated, so an
+    // item never moves once written. Anything that can throw happens before
+    // the index is claimed, so a failed add leaves no hole behind. Each segment is allocated by a single
+    // writer ahead of need; only a writer that outruns it waits. Readers see
+    // the longest prefix whose items are all fully written, so a writer that
+    // stalls mid-construction holds size() back until it finishes. size()
+    // and getItemAt never block and run safely alongside writers.
+    template <typename ItemType = std::string>
+    class ConcurrentCatalog {
+        static_assert(std::is_nothrow_move_constructible_v<ItemType>, "Items are moved into a claimed slot, which must not fail");
+
+        static constexpr size_t kFirstSegmentShift = 10;
+        static constexpr size_t kSegmentCount = 64 - kFirstSegmentShift;
+
+        struct Slot {
+            alignas(ItemType) std::byte storage[sizeof(ItemType)];
+            std::atomic<bool> ready{false};
+        };
+
+        std::atomic<Slot *> segments_[kSegmentCount] = {};
+        std::atomic<size_t> reserved_{0};
+        std::atomic<size_t> committed_{0};
+
+        // Segment k holds indices [(2^k - 1) << shift, (2^(k+1) - 1) << shift).
+        static size_t SegmentOf(size_t i) { return std::bit_width((i >> kFirstSegmentShift) + 1) - 1; }
+        static size_t SegmentStart(size_t k) { return ((size_t{1} << k) - 1) << kFirstSegmentShift; }
+        static size_t SegmentSize(size_t k) { return size_t{1} << (k + kFirstSegmentShift); }
+
+        // Placeholder published while one writer allocates a segment.
+        static Slot *Allocating() { return reinterpret_cast<Slot *>(alignof(Slot)); }
+
+        // Segment k, allocating it if no writer has yet. If the allocation
+        // throws, the segment is left unallocated for the next writer to try.
+        Slot *Segment(size_t k) {
+            for (;;) {
+                Slot *segment = segments_[k].load(std::memory_order_acquire);
+                if (segment == nullptr) {
+                    if (!segments_[k].compare_exchange_strong(segment, Allocating(), std::memory_order_acq_rel)) {
+                        continue;
+                    }
+                    try {
+                        segment = new Slot[SegmentSize(k)];
+                    } catch (...) {
+                        segments_[k].store(nullptr, std::memory_order_release);
+                        throw;
+                    }
+                    segments_[k].store(segment, std::memory_order_release);
+                    return segment;
+                }
+                if (segment != Allocating()) {
+                    return segment;
+                }
+                // Another writer is allocating this segment. This happens at
+                // most once per segment, so appends rarely wait.
+                std::this_thread::yield();
+            }
         }
 
-        InventorySystem::WarehouseInventory<int, int> inv_test{1, 2};
+        Slot &SlotFor(size_t i) {
+            size_t const k = SegmentOf(i);
+            size_t const offset = i - SegmentStart(k);
+            // The writer halfway through a segment allocates the next one, so
+            // writers rarely find a segment missing and have to wait for it.
+            if (offset == SegmentSize(k) / 2 && k + 1 < kSegmentCount) {
+                Segment(k + 1);
+            }
+            return Segment(k)[offset];
+        }
 
-        static_assert(std::is_same_v<decltype(inv_test.getItemName()), int>, "Type should be int for Item");
-        static_assert(std::is_same_v<decltype(inv_test.getLocation()), int>, "Type should be int for Location");
+        Slot const &SlotAt(size_t i) const {
+            size_t const k = SegmentOf(i);
+            return segments_[k].load(std::memory_order_acquire)[i - SegmentStart(k)];
+        }
 
-        std::cout << "Item test item, Location, Int type parameters passed: Item name: " << inv_test.getItemName() << " Location: " << inv_test.getLocation() << std::endl;
+        // Moves committed_ past every slot that has finished; whichever writer
+        // completes the slot at the front sweeps forward over later ones.
+        // Callers have just set their own ready flag. That store and the
+        // flag loads here are seq_cst, so of two writers finishing together
+        // at least one sees the other's flag and no slot is left behind.
+        void AdvanceCommitted() {
+            size_t committed = committed_.load(std::memory_order_acquire);
+            while (committed < reserved_.load(std::memory_order_acquire)) {
+                size_t const k = SegmentOf(committed);
+                Slot const *segment = segments_[k].load(std::memory_order_acquire);
+                if (segment == nullptr || segment == Allocating() ||
+                    !segment[committed - SegmentStart(k)].ready.load(std::memory_order_seq_cst)) {
+                    return;
+                }
+                if (committed_.compare_exchange_weak(committed, committed + 1, std::memory_order_acq_rel)) {
+                    ++committed;
+                }
+            }
+        }
 
-        // Test Partial specialization
-        InventorySystem::WarehouseInventory<std::pair<std::string, float>, std::string> electronic_inventory({"Transistor", 1.0}, "Warehouse C", 3);
+    public:
+        using Item = ItemType;
 
-        // This check should pass for base class
-        InventorySystem::WarehouseInventory<std::pair<std::string, float>, std::string>::ShowInventoryDetails(std::cout, "Extra info1", "Extra Info2");
+        ConcurrentCatalog() = default;
+        ConcurrentCatalog(ConcurrentCatalog const &) = delete;
+        ConcurrentCatalog &operator=(ConcurrentCatalog const &) = delete;
 
-        static_assert(std::is_same_v<decltype(electronic_inventory.item_name_), std::pair<std::string, float>>, "Item should be a pair");
+        ~ConcurrentCatalog() {
+            size_t const reserved = reserved_.load(std::memory_order_acquire);
+            for (size_t k = 0; k < kSegmentCount; ++k) {
+                Slot *segment = segments_[k].load(std::memory_order_acquire);
+                if (segment == nullptr) {
+                    continue;
+                }
+                if constexpr (!std::is_trivially_destructible_v<ItemType>) {
+                    size_t const end = std::min(reserved, SegmentStart(k) + SegmentSize(k));
+                    for (size_t i = SegmentStart(k); i < end; ++i) {
+                        std::destroy_at(std::launder(reinterpret_cast<ItemType *>(segment[i - SegmentStart(k)].storage)));
+                    }
+                }
+                delete[] segment;
+            }
+        }
 
-        if (electronic_inventory.item_name_.first == "Transistor" && electronic_inventory.getShelfNumber() == 3) {
-            std::cout << "Partial Specialization works: Item name " << electronic_inventory.item_name_.first << ", Shelf: " << electronic_inventory.getShelfNumber() << std::endl;
-        } else {
-            throw std::runtime_error("Partial Specialization does not match");
+        // Safe to call from any number of threads. Returns the item's index.
+        // If building the item or allocating its segment throws, no index
+        // is claimed and the catalog is unchanged.
+        template <typename... Args>
+        size_t emplace_item(Args &&...args) {
+            ItemType item(std::forward<Args>(args)...);
+            size_t index = reserved_.load(std::memory_order_relaxed);
+            Slot *slot;
+            do {
+                slot = &SlotFor(index);
+            } while (!reserved_.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel, std::memory_order_relaxed));
+            ::new (static_cast<void *>(slot->storage)) ItemType(std::move(item));
+            slot->ready.store(true, std::memory_order_seq_cst);
+            AdvanceCommitted();
+            return index;
         }
-    }
 
-    void RunTests() {
-        TestCatalog();
-        TestWarehouseInventory();
+        size_t add_item(ItemType const &item) { return emplace_item(item); }
 
-        std::cout << "All tests Completed Successfully" << std::endl;
-    }
-} // namespace Tests
+        size_t add_item(ItemType &&item) { return emplace_item(std::move(item)); }
 
-int main() {
-    Tests::RunTests();
+        // i must be below size().
+        ItemType const &operator[](size_t i) const {
+            return *std::launder(reinterpret_cast<ItemType const *>(SlotAt(i).storage));
+        }
+
+        ItemType getItemAt(size_t i) const { return (*this)[i]; }
+
+        // Number of items visible to readers: every index below it is fully
+        // written. Writers still in flight are not counted.
+        size_t size() const { return committed_.load(std::memory_order_acquire); }
+    };
+
+    // Catalog with read-copy-update snapshots. Items live in fixed-size
+    // blocks that never move. A version is an immutable (block table, size)
+    // pair published through one atomic pointer. Writers take a mutex, add
+    // items past the published size, then swap in a new version. Readers
+    // register once per thread and pin an epoch for each snapshot. A snapshot
+    // never takes a lock and never sees later writes. Replaced versions and
+    // block tables are freed by epoch-based reclamation once no pinned
+    // reader can still hold them.
+    template <typename ItemType = std::string>
+    class RcuCatalog {
+        static constexpr size_t kBlockShift = 10;
+        static constexpr size_t kBlockSize = size_t{1} << kBlockShift;
+        static constexpr uint64_t kIdle = UINT64_MAX;
+
+        struct Block {
+            alignas(ItemType) std::byte storage[sizeof(ItemType) * kBlockSize];
+        };
+
+        // Writers only fill entries at or beyond count, which no published
+        // version reads, so a table is shared until it runs out of capacity.
+        struct Table {
+            size_t capacity;
+            std::unique_ptr<Block *[]> blocks;
+        };
+
+        struct Version {
+            Table const *table;
+            size_t size;
+        };
+
+        struct alignas(64) ReaderSlot {
+            std::atomic<uint64_t> epoch{kIdle};
+            std::atomic<bool> claimed{false};
+        };
+
+        struct Retired {
+            uint64_t epoch;
+            Version const *version;
+            Table const *table;
+        };
+
+    public:
+        static constexpr size_t kMaxReaders = 256;
+
+        // A pinned, consistent view of the catalog. It must not outlive the
+        // Reader that made it.
+        class Snapshot {
+            friend class RcuCatalog;
+            ReaderSlot *slot_;
+            Version const *version_;
+
+            Snapshot(ReaderSlot *slot, Version const *version) : slot_(slot), version_(version) {}
+
+        public:
+            Snapshot(Snapshot const &) = delete;
+            Snapshot &operator=(Snapshot const &) = delete;
+            ~Snapshot() { slot_->epoch.store(kIdle, std::memory_order_release); }
+
+            ItemType const &operator[](size_t i) const {
+                Block const *block = version_->table->blocks[i >> kBlockShift];
+                return *std::launder(reinterpret_cast<ItemType const *>(block->storage) + (i & (kBlockSize - 1)));
+            }
+
+            ItemType getItemAt(size_t i) const { return (*this)[i]; }
+
+            size_t size() const { return version_->size; }
+        };
+
+        // Per-thread registration. Each reader thread owns one; it holds at
+        // most one Snapshot at a time.
+        class Reader {
+            friend class RcuCatalog;
+            RcuCatalog const *catalog_;
+            ReaderSlot *slot_;
+
+            Reader(RcuCatalog const *catalog, ReaderSlot *slot) : catalog_(catalog), slot_(slot) {}
+
+        public:
+            Reader(Reader &&other) noexcept : catalog_(other.catalog_), slot_(std::exchange(other.slot_, nullptr)) {}
+            Reader &operator=(Reader &&) = delete;
+            ~Reader() {
+                if (slot_) {
+                    slot_->claimed.store(false, std::memory_order_release);
+                }
+            }
+
+            Snapshot snapshot() const {
+                // The pin must be visible before the version is read, so that
+                // a writer retiring this version sees the reader.
+                slot_->epoch.store(catalog_->epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+                return {slot_, catalog_->version_.load(std::memory_order_seq_cst)};
+            }
+        };
+
+        RcuCatalog() : slots_(std::make_unique<ReaderSlot[]>(kMaxReaders)) {
+            auto *table = new Table{16, std::make_unique<Block *[]>(16)};
+            version_.store(new Version{table, 0});
+        }
+
+        RcuCatalog(RcuCatalog const &) = delete;
+        RcuCatalog &operator=(RcuCatalog const &) = delete;
+
+        // All readers must be gone.
+        ~RcuCatalog() {
+            Version const *version = version_.load();
+            for (size_t i = 0; i < version->size; ++i) {
+                std::destroy_at(std::launder(reinterpret_cast<ItemType *>(blocks_[i >> kBlockShift]->storage) + (i & (kBlockSize - 1))));
+            }
+            for (Block *block : blocks_) {
+                delete block;
+            }
+            for (Retired const &retired : retired_) {
+                delete retired.version;
+                delete retired.table;
+            }
+            delete version->table;
+            delete version;
+        }
+
+        Reader reader() const {
+            for (size_t i = 0; i < kMaxReaders; ++i) {
+                bool expected = false;
+                if (slots_[i].claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    // Writers only scan slots below the limit.
+                    size_t limit = slot_limit_.load();
+                    while (limit <= i && !slot_limit_.compare_exchange_weak(limit, i + 1)) {
+                    }
+                    return {this, &slots_[i]};
+                }
+            }
+            throw std::length_error("RcuCatalog: too many concurrent readers");
+        }
+
+        void add_item(ItemType item) {
+            std::lock_guard lock(write_mutex_);
+            Version const *current = version_.load(std::memory_order_relaxed);
+            Table const *table = Append(current, std::move(item));
+            Publish(current, table, current->size + 1);
+        }
+
+        // Adds a batch of items under one published version.
+        template <std::ranges::input_range Items>
+        void add_items(Items &&items) {
+            std::lock_guard lock(write_mutex_);
+            Version const *current = version_.load(std::memory_order_relaxed);
+            Version staged = *current;
+            try {
+                for (auto &&item : items) {
+                    Table const *table = Append(&staged, ItemType(std::forward<decltype(item)>(item)));
+                    if (table != staged.table && staged.table != current->table) {
+                        delete staged.table;  // staged here, never published
+                    }
+                    staged.table = table;
+                    ++staged.size;
+                }
+            } catch (...) {
+                // Keep the items added so far rather than leak them.
+                Publish(current, staged.table, staged.size);
+                throw;
+            }
+            Publish(current, staged.table, staged.size);
+        }
+
+        // Replaced versions and tables not yet freed.
+        size_t pending_reclaim() const {
+            std::lock_guard lock(write_mutex_);
+            return retired_.size();
+        }
+
+    private:
+        // Constructs item at index version->size and returns the table to
+        // publish with it: the same one, or a larger copy. On a throw nothing
+        // is leaked and the old table is untouched; freeing a table it
+        // replaced is up to the caller.
+        Table const *Append(Version const *version, ItemType &&item) {
+            size_t const index = version->size;
+            size_t const block = index >> kBlockShift;
+            Table const *table = version->table;
+            std::unique_ptr<Table> grown;
+            if ((index & (kBlockSize - 1)) == 0) {
+                if (block == table->capacity) {
+                    grown.reset(new Table{2 * table->capacity, std::make_unique<Block *[]>(2 * table->capacity)});
+                    std::copy_n(table->blocks.get(), table->capacity, grown->blocks.get());
+                    table = grown.get();
+                }
+                // A block survives a failed append, so a retry reuses it.
+                if (block == blocks_.size()) {
+                    auto fresh = std::make_unique<Block>();
+                    blocks_.push_back(fresh.get());
+                    fresh.release();
+                }
+                table->blocks[block] = blocks_[block];
+            }
+            ::new (static_cast<void *>(reinterpret_cast<ItemType *>(table->blocks[block]->storage) + (index & (kBlockSize - 1))))
+                ItemType(std::move(item));
+            grown.release();
+            return table;
+        }
+
+        void Publish(Version const *current, Table const *table, size_t size) {
+            version_.store(new Version{table, size}, std::memory_order_seq_cst);
+            retired_.push_back({epoch_.load(std::memory_order_seq_cst), current, table != current->table ? current->table : nullptr});
+            Reclaim();
+        }
+
+        // Advances the epoch if every pinned reader has seen the current
+        // one, then frees what was retired two or more epochs ago.
+        void Reclaim() {
+            uint64_t const epoch = epoch_.load(std::memory_order_seq_cst);
+            size_t const limit = slot_limit_.load(std::memory_order_seq_cst);
+            for (size_t i = 0; i < limit; ++i) {
+                uint64_t const pinned = slots_[i].epoch.load(std::memory_order_seq_cst);
+                if (pinned != kIdle && pinned != epoch) {
+                    return;
+                }
+            }
+            epoch_.store(epoch + 1, std::memory_order_seq_cst);
+
+            auto const keep = std::partition(retired_.begin(), retired_.end(), [&](Retired const &r) { return r.epoch + 2 > epoch + 1; });
+            for (auto it = keep; it != retired_.end(); ++it) {
+                delete it->version;
+                delete it->table;
+            }
+            retired_.erase(keep, retired_.end());
+        }
+
+        std::atomic<Version const *> version_{nullptr};
+        std::atomic<uint64_t> epoch_{0};
+        std::unique_ptr<ReaderSlot[]> slots_;
+        mutable std::atomic<size_t> slot_limit_{0};
+        mutable std::mutex write_mutex_;
+        std::vector<Block *> blocks_;
+        std::vector<Retired> retired_;
+    };
+
+    // Columnar store for WarehouseInventory records: items and locations
+    // live in separate arrays, and each location is stored as a 32-bit code
+    // into a dictionary of distinct locations. Queries by location compare
+    // codes only, so a scan reads 4 bytes per record instead of the whole
+    // object, and they return row IDs into the columns.
+    template <typename ItemType = std::string, typename LocationType = std::string>
+    class InventoryTable {
+    public:
+        using Item = ItemType;
+        using Location = LocationType;
+        using Row = uint32_t;
+
+        size_t add_record(Item item, Location const &location) {
+            if (items_.size() >= UINT32_MAX) {
+                throw std::length_error("InventoryTable: more records than 32-bit row IDs");
+            }
+            uint32_t code;
+            if (auto const existing = dictionary_.find(location)) {
+                code = static_cast<uint32_t>(*existing);
+            } else {
+                code = static_cast<uint32_t>(dictionary_.size());
+                dictionary_.add_item(location);
+            }
+            items_.push_back(std::move(item));
+            codes_.push_back(code);
+            return items_.size() - 1;
+        }
+
+        size_t add_record(WarehouseInventory<Item, Location> const &record) {
+            return add_record(record.item_name_, record.location_);
+        }
+
+        void reserve(size_t n) {
+            items_.reserve(n);
+            codes_.reserve(n);
+        }
+
+        Item const &item(Row row) const { return items_[row]; }
+        Location const &location(Row row) const { return dictionary_[codes_[row]]; }
+        WarehouseInventory<Item, Location> record(Row row) const { return {item(row), location(row)}; }
+
+        // Dictionary code of a location, if any record has it.
+        std::optional<uint32_t> location_code(Location const &location) const {
+            if (auto const code = dictionary_.find(location)) {
+                return static_cast<uint32_t>(*code);
+            }
+            return std::nullopt;
+        }
+
+        // Number of records at location.
+        size_t count_at(Location const &location) const {
+            auto const code = location_code(location);
+            return code ? count_code(*code) : 0;
+        }
+
+        size_t count_code(uint32_t code) const {
+            size_t count = 0;
+            size_t const n = codes_.size();
+            size_t i = 0;
+#if defined(__SSE2__)
+            // Each matching lane of a compare is -1, so subtracting the
+            // compare results counts matches in four 32-bit lanes. The lanes
+            // are drained before they can overflow.
+            __m128i const needle = _mm_set1_epi32(static_cast<int>(code));
+            while (i + 4 <= n) {
+                size_t const stop = std::min(n & ~size_t{3}, i + (size_t{1} << 30));
+                __m128i lanes = _mm_setzero_si128();
+                for (; i < stop; i += 4) {
+                    __m128i const group = _mm_loadu_si128(reinterpret_cast<__m128i const *>(&codes_[i]));
+                    lanes = _mm_sub_epi32(lanes, _mm_cmpeq_epi32(group, needle));
+                }
+                alignas(16) uint32_t partial[4];
+                _mm_store_si128(reinterpret_cast<__m128i *>(partial), lanes);
+                count += size_t{partial[0]} + partial[1] + partial[2] + partial[3];
+            }
+#endif
+            for (; i < n; ++i) {
+                count += codes_[i] == code;
+            }
+            return count;
+        }
+
+        // Row IDs of the records at location, in ascending order.
+        std::vector<Row> select_at(Location const &location) const {
+            auto const code = location_code(location);
+            return code ? select_code(*code) : std::vector<Row>{};
+        }
+
+        std::vector<Row> select_code(uint32_t code) const {
+            std::vector<Row> rows(count_code(code));
+            Row *out = rows.data();
+            size_t const n = codes_.size();
+            size_t i = 0;
+#if defined(__SSE2__)
+            // Compare four codes at a time; only groups with a match are
+            // expanded into row IDs.
+            __m128i const needle = _mm_set1_epi32(static_cast<int>(code));
+            for (; i + 4 <= n; i += 4) {
+                __m128i const group = _mm_loadu_si128(reinterpret_cast<__m128i const *>(&codes_[i]));
+                for (int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(group, needle))); mask != 0; mask &= mask - 1) {
+                    *out++ = static_cast<Row>(i + std::countr_zero(static_cast<unsigned>(mask)));
+                }
+            }
+#endif
+            for (; i < n; ++i) {
+                if (codes_[i] == code) {
+                    *out++ = static_cast<Row>(i);
+                }
+            }
+            return rows;
+        }
+
+        // Record count per location, indexed by location code.
+        std::vector<size_t> group_counts() const {
+            std::vector<size_t> counts(dictionary_.size());
+            for (uint32_t c : codes_) {
+                ++counts[c];
+            }
+            return counts;
+        }
+
+        std::span<Item const> items() const { return items_; }
+        std::span<uint32_t const> location_codes() const { return codes_; }
+        std::span<Location const> locations() const { return dictionary_.items(); }
+
+        size_t size() const { return items_.size(); }
+
+    private:
+        std::vector<Item> items_;
+        std::vector<uint32_t> codes_;
+        Catalog<Location, std::vector, SwissIndex<Location>> dictionary_;
+    };
+
+    // Ordered multimap as a B+-tree with wide nodes. Keys and values are kept
+    // in separate arrays inside each node, so a search compares neighbouring
+    // keys in one or two cache lines, and the leaves are linked for ordered
+    // iteration. Erase removes the entry from its leaf but never merges
+    // nodes; a leaf left empty is simply skipped by iteration. Equal keys
+    // keep their insertion order.
+    template <typename Key, typename Value, size_t Fanout = 32>
+    class BPlusTree {
+        static_assert(Fanout >= 4, "Fanout must allow splitting nodes");
+
+        struct Leaf {
+            size_t count = 0;
+            Leaf *next = nullptr;
+            Key keys[Fanout];
+            Value values[Fanout];
+        };
+
+        struct Inner {
+            size_t count = 0;  // number of keys; children has count + 1 entries
+            Key keys[Fanout];
+            void *children[Fanout + 1];
+        };
+
+        // Nodes are owned here, so the tree holds only plain pointers.
+        std::vector<std::unique_ptr<Leaf>> leaves_;
+        std::vector<std::unique_ptr<Inner>> inners_;
+        void *root_ = nullptr;
+        size_t height_ = 0;  // inner levels above the leaves
+        size_t size_ = 0;
+
+        Leaf *NewLeaf() { return leaves_.emplace_back(std::make_unique<Leaf>()).get(); }
+        Inner *NewInner() { return inners_.emplace_back(std::make_unique<Inner>()).get(); }
+
+        // Leftmost leaf that can hold key (or the first key after it).
+        Leaf *DescendLower(Key const &key) const {
+            void *node = root_;
+            for (size_t level = 0; level < height_; ++level) {
+                auto *inner = static_cast<Inner *>(node);
+                node = inner->children[std::lower_bound(inner->keys, inner->keys + inner->count, key) - inner->keys];
+            }
+            return static_cast<Leaf *>(node);
+        }
+
+        struct Split {
+            Key separator;
+            void *right;
+        };
+
+        // Inserts after any equal keys below node; returns the new right
+        // sibling and its separator when node had to split.
+        std::optional<Split> InsertInto(void *node, size_t level, Key const &key, Value const &value) {
+            if (level == height_) {
+                auto *leaf = static_cast<Leaf *>(node);
+                size_t const at = std::upper_bound(leaf->keys, leaf->keys + leaf->count, key) - leaf->keys;
+                if (leaf->count < Fanout) {
+                    InsertAt(leaf, at, key, value);
+                    return std::nullopt;
+                }
+
+                Leaf *right = NewLeaf();
+                size_t const half = Fanout / 2;
+                std::move(leaf->keys + half, leaf->keys + Fanout, right->keys);
+                std::move(leaf->values + half, leaf->values + Fanout, right->values);
+                right->count = Fanout - half;
+                leaf->count = half;
+                right->next = leaf->next;
+                leaf->next = right;
+                if (at <= half) {
+                    InsertAt(leaf, at, key, value);
+                } else {
+                    InsertAt(right, at - half, key, value);
+                }
+                return Split{right->keys[0], right};
+            }
+
+            auto *inner = static_cast<Inner *>(node);
+            size_t const child = std::upper_bound(inner->keys, inner->keys + inner->count, key) - inner->keys;
+            auto split = InsertInto(inner->children[child], level + 1, key, value);
+            if (!split) {
+                return std::nullopt;
+            }
+            if (inner->count < Fanout) {
+                InsertChild(inner, child, std::move(split->separator), split->right);
+                return std::nullopt;
+            }
+
+            // Split around the middle key, which moves up to the parent.
+            Inner *right = NewInner();
+            size_t const half = Fanout / 2;
+            Key up = std::move(inner->keys[half]);
+            std::move(inner->keys + half + 1, inner->keys + Fanout, right->keys);
+            std::copy(inner->children + half + 1, inner->children + Fanout + 1, right->children);
+            right->count = Fanout - half - 1;
+            inner->count = half;
+            if (child <= half) {
+                InsertChild(inner, child, std::move(split->separator), split->right);
+            } else {
+                InsertChild(right, child - half - 1, std::move(split->separator), split->right);
+            }
+            return Split{std::move(up), right};
+        }
+
+        static void InsertAt(Leaf *leaf, size_t at, Key const &key, Value const &value) {
+            std::move_backward(leaf->keys + at, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+            std::move_backward(leaf->values + at, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+            leaf->keys[at] = key;
+            leaf->values[at] = value;
+            ++leaf->count;
+        }
+
+        // Places separator at keys[at] and its right subtree at children[at + 1].
+        static void InsertChild(Inner *inner, size_t at, Key separator, void *right) {
+            std::move_backward(inner->keys + at, inner->keys + inner->count, inner->keys + inner->count + 1);
+            std::copy_backward(inner->children + at + 1, inner->children + inner->count + 1, inner->children + inner->count + 2);
+            inner->keys[at] = std::move(separator);
+            inner->children[at + 1] = right;
+            ++inner->count;
+        }
+
+    public:
+        // Forward iterator over values in key order; key() gives the key.
+        class Iterator {
+            friend class BPlusTree;
+            Leaf const *leaf_ = nullptr;
+            size_t slot_ = 0;
+
+            Iterator(Leaf const *leaf, size_t slot) : leaf_(leaf), slot_(slot) { SkipExhausted(); }
+
+            void SkipExhausted() {
+                while (leaf_ && slot_ >= leaf_->count) {
+                    leaf_ = leaf_->next;
+                    slot_ = 0;
+                }
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Value;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value const *;
+            using reference = Value const &;
+
+            Iterator() = default;
+
+            reference operator*() const { return leaf_->values[slot_]; }
+            pointer operator->() const { return &leaf_->values[slot_]; }
+            Key const &key() const { return leaf_->keys[slot_]; }
+
+            Iterator &operator++() {
+                ++slot_;
+                SkipExhausted();
+                return *this;
+            }
+            Iterator operator++(int) {
+                Iterator old = *this;
+                ++*this;
+                return old;
+            }
+
+            friend bool operator==(Iterator const &a, Iterator const &b) { return a.leaf_ == b.leaf_ && a.slot_ == b.slot_; }
+        };
+
+        struct Range {
+            Iterator first, last;
+            Iterator begin() const { return first; }
+            Iterator end() const { return last; }
+            bool empty() const { return first == last; }
+        };
+
+        BPlusTree() : root_(NewLeaf()) {}
+
+        void insert(Key const &key, Value const &value) {
+            if (auto split = InsertInto(root_, 0, key, value)) {
+                Inner *root = NewInner();
+                root->keys[0] = std::move(split->separator);
+                root->children[0] = root_;
+                root->children[1] = split->right;
+                root->count = 1;
+                root_ = root;
+                ++height_;
+            }
+            ++size_;
+        }
+
+        // Removes one entry with this key and value; false if there is none.
+        bool erase(Key const &key, Value const &value) {
+            for (auto it = lower_bound(key); it != end() && !(key < it.key()); ++it) {
+                if (*it == value) {
+                    auto *leaf = const_cast<Leaf *>(it.leaf_);
+                    std::move(leaf->keys + it.slot_ + 1, leaf->keys + leaf->count, leaf->keys + it.slot_);
+                    std::move(leaf->values + it.slot_ + 1, leaf->values + leaf->count, leaf->values + it.slot_);
+                    --leaf->count;
+                    --size_;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // First entry whose key is not less than key.
+        Iterator lower_bound(Key const &key) const {
+            Leaf const *leaf = DescendLower(key);
+            return {leaf, static_cast<size_t>(std::lower_bound(leaf->keys, leaf->keys + leaf->count, key) - leaf->keys)};
+        }
+
+        // First entry whose key is greater than key.
+        Iterator upper_bound(Key const &key) const {
+            Iterator it = lower_bound(key);
+            while (it != end() && !(key < it.key())) {
+                ++it;
+            }
+            return it;
+        }
+
+        // Entries equal to key.
+        Range equal_range(Key const &key) const { return {lower_bound(key), upper_bound(key)}; }
+
+        // Entries with first <= key < last.
+        Range range(Key const &first, Key const &last) const {
+            return {lower_bound(first), last < first ? lower_bound(first) : lower_bound(last)};
+        }
+
+        // Entries whose key starts with prefix, for string-like keys.
+        Range prefix(std::string_view prefix) const requires std::is_convertible_v<Key const &, std::string_view> {
+            std::string bound(prefix);
+            // The smallest string above every extension of the prefix: drop
+            // trailing 0xff bytes and increment the last remaining one.
+            while (!bound.empty() && static_cast<unsigned char>(bound.back()) == 0xff) {
+                bound.pop_back();
+            }
+            Iterator const first = lower_bound(Key(prefix));
+            if (bound.empty()) {
+                return {first, end()};
+            }
+            ++bound.back();
+            return {first, lower_bound(Key(bound))};
+        }
+
+        size_t count(Key const &key) const { return static_cast<size_t>(std::distance(lower_bound(key), upper_bound(key))); }
+
+        Iterator begin() const { return {leaves_.front().get(), 0}; }
+        Iterator end() const { return {}; }
+
+        size_t size() const { return size_; }
+        size_t height() const { return height_ + 1; }
+    };
+
+    // Secondary index over WarehouseInventory records, ordered by location.
+    // It points at records owned elsewhere, which must stay at the same
+    // address while indexed.
+    template <typename ItemType = std::string, typename LocationType = std::string>
+    class LocationIndex {
+    public:
+        using Record = WarehouseInventory<ItemType, LocationType>;
+        using Tree = BPlusTree<LocationType, Record const *>;
+        using Range = typename Tree::Range;
+
+        void add(Record const &record) { tree_.insert(record.location_, &record); }
+        bool remove(Record const &record) { return tree_.erase(record.location_, &record); }
+
+        // Records at location, in the order they were added.
+        Range at(LocationType const &location) const { return tree_.equal_range(location); }
+
+        // Records with first <= location < last, ordered by location.
+        Range between(LocationType const &first, LocationType const &last) const { return tree_.range(first, last); }
+
+        // Records whose location starts with prefix.
+        Range with_prefix(std::string_view prefix) const requires std::is_convertible_v<LocationType const &, std::string_view> {
+            return tree_.prefix(prefix);
+        }
+
+        auto begin() const { return tree_.begin(); }
+        auto end() const { return tree_.end(); }
+
+        size_t size() const { return tree_.size(); }
+
+    private:
+        Tree tree_;
+    };
+
+    // Binary snapshots. A snapshot file is a header followed by one section
+    // per column, each starting on a 64-byte boundary. Trivially copyable
+    // values are stored as a fixed-width array. Strings are stored as
+    // rows + 1 uint64 offsets into a heap of concatenated bytes. The views
+    // below map the file read-only and read values in place, so opening a
+    // snapshot costs the same regardless of its size, and processes that
+    // map the same file share its pages.
+    namespace Snapshot {
+        inline constexpr char kMagic[8] = {'N', '2', '1', '7', 'S', 'N', 'A', 'P'};
+        inline constexpr uint32_t kVersion = 1;
+        inline constexpr size_t kAlignment = 64;
+
+        enum class Kind : uint32_t { Catalog = 1, Inventory = 2 };
+        enum class Encoding : uint32_t { Fixed = 1, String = 2 };
+
+        struct ColumnInfo {
+            Encoding encoding;
+            uint32_t width;  // bytes per value for Fixed columns
+            uint64_t data_offset;
+            uint64_t heap_offset;
+            uint64_t heap_size;
+        };
+
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            Kind kind;
+            uint64_t rows;
+            uint32_t column_count;
+            uint32_t reserved;
+            ColumnInfo columns[2];
+        };
+
+        template <typename T>
+        constexpr bool kIsString = std::is_convertible_v<T const &, std::string_view>;
+
+        // Whether count values of width bytes starting at offset fit in a
+        // file of size bytes, without overflowing on corrupt inputs.
+        inline bool InFile(uint64_t offset, uint64_t count, uint64_t width, uint64_t size) {
+            return offset <= size && count <= (size - offset) / width;
+        }
+
+        template <typename T>
+        constexpr Encoding EncodingOf() {
+            static_assert(kIsString<T> || (std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>),
+                          "Snapshot columns hold strings or trivially copyable values");
+            return kIsString<T> ? Encoding::String : Encoding::Fixed;
+        }
+
+        // Buffered sequential writer that tracks the file offset.
+        class FileWriter {
+            std::FILE *file_;
+            uint64_t offset_ = 0;
+
+        public:
+            explicit FileWriter(std::string const &path) : file_(std::fopen(path.c_str(), "wb")) {
+                if (!file_) {
+                    throw std::system_error(errno, std::generic_category(), "Snapshot: cannot create " + path);
+                }
+                std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+            }
+            FileWriter(FileWriter const &) = delete;
+            FileWriter &operator=(FileWriter const &) = delete;
+            ~FileWriter() {
+                if (file_) {
+                    std::fclose(file_);
+                }
+            }
+
+            void Write(void const *data, size_t size) {
+                if (size != 0 && std::fwrite(data, 1, size, file_) != size) {
+                    throw std::system_error(errno, std::generic_category(), "Snapshot: write failed");
+                }
+                offset_ += size;
+            }
+
+            void Align() {
+                static constexpr char zeros[kAlignment] = {};
+                Write(zeros, (kAlignment - offset_ % kAlignment) % kAlignment);
+            }
+
+            void WriteAt(uint64_t offset, void const *data, size_t size) {
+                if (std::fseek(file_, static_cast<long>(offset), SEEK_SET) != 0 || std::fwrite(data, 1, size, file_) != size) {
+                    throw std::system_error(errno, std::generic_category(), "Snapshot: write failed");
+                }
+            }
+
+            void Close() {
+                std::FILE *file = std::exchange(file_, nullptr);
+                if (std::fclose(file) != 0) {
+                    throw std::system_error(errno, std::generic_category(), "Snapshot: close failed");
+                }
+            }
+
+            uint64_t offset() const { return offset_; }
+        };
+
+        // Writes the column produced by value(row) for rows [0, rows).
+        template <typename T, typename GetValue>
+        ColumnInfo WriteColumn(FileWriter &out, uint64_t rows, GetValue const &value) {
+            ColumnInfo info{EncodingOf<T>(), 0, 0, 0, 0};
+            out.Align();
+            info.data_offset = out.offset();
+            if constexpr (kIsString<T>) {
+                uint64_t end = 0;
+                out.Write(&end, sizeof end);
+                for (uint64_t row = 0; row < rows; ++row) {
+                    end += std::string_view(value(row)).size();
+                    out.Write(&end, sizeof end);
+                }
+                info.heap_offset = out.offset();
+                info.heap_size = end;
+                for (uint64_t row = 0; row < rows; ++row) {
+                    std::string_view const text(value(row));
+                    out.Write(text.data(), text.size());
+                }
+            } else {
+                info.width = sizeof(T);
+                for (uint64_t row = 0; row < rows; ++row) {
+                    T const item = value(row);
+                    out.Write(&item, sizeof item);
+                }
+            }
+            return info;
+        }
+
+        template <typename... Columns>
+        void WriteFile(std::string const &path, Kind kind, uint64_t rows, Columns const &...columns) {
+            FileWriter out(path);
+            Header header{};
+            std::memcpy(header.magic, kMagic, sizeof kMagic);
+            header.version = kVersion;
+            header.kind = kind;
+            header.rows = rows;
+            header.column_count = sizeof...(Columns);
+            out.Write(&header, sizeof header);
+
+            size_t column = 0;
+            ((header.columns[column++] = columns(out)), ...);
+            out.WriteAt(0, &header, sizeof header);
+            out.Close();
+        }
+
+        // A snapshot file mapped read-only, with its header checked.
+        class MappedFile {
+            void const *base_ = nullptr;
+            size_t size_ = 0;
+
+        public:
+            MappedFile(std::string const &path, Kind kind) {
+                int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    throw std::system_error(errno, std::generic_category(), "Snapshot: cannot open " + path);
+                }
+                struct stat st {};
+                if (::fstat(fd, &st) != 0) {
+                    int const error = errno;
+                    ::close(fd);
+                    throw std::system_error(error, std::generic_category(), "Snapshot: cannot stat " + path);
+                }
+                size_ = static_cast<size_t>(st.st_size);
+                if (size_ < sizeof(Header)) {
+                    ::close(fd);
+                    throw std::runtime_error("Snapshot: " + path + " is too small");
+                }
+                void *base = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+                ::close(fd);
+                if (base == MAP_FAILED) {
+                    throw std::system_error(errno, std::generic_category(), "Snapshot: cannot map " + path);
+                }
+                base_ = base;
+
+                Header const &h = header();
+                if (std::memcmp(h.magic, kMagic, sizeof kMagic) != 0 || h.version != kVersion || h.kind != kind) {
+                    ::munmap(const_cast<void *>(base_), size_);
+                    throw std::runtime_error("Snapshot: " + path + " is not a version " + std::to_string(kVersion) + " snapshot of this kind");
+                }
+            }
+            MappedFile(MappedFile const &) = delete;
+            MappedFile &operator=(MappedFile const &) = delete;
+            ~MappedFile() { ::munmap(const_cast<void *>(base_), size_); }
+
+            Header const &header() const { return *static_cast<Header const *>(base_); }
+            std::byte const *at(uint64_t offset) const { return static_cast<std::byte const *>(base_) + offset; }
+            size_t size() const { return size_; }
+        };
+
+        // Read access to one column of a mapped snapshot. Strings come back
+        // as views into the mapping; fixed-width values are copied out.
+        template <typename T>
+        class Column {
+            std::byte const *data_ = nullptr;
+            char const *heap_ = nullptr;
+
+        public:
+            using value_type = std::conditional_t<kIsString<T>, std::string_view, T>;
+
+            Column() = default;
+
+            // Checks every bound operator[] relies on, so a corrupt file is
+            // rejected here instead of being read out of bounds later.
+            Column(MappedFile const &file, size_t index) {
+                Header const &h = file.header();
+                if (index >= h.column_count || index >= std::size(h.columns)) {
+                    throw std::runtime_error("Snapshot: missing column");
+                }
+                ColumnInfo const &info = h.columns[index];
+                if (info.encoding != EncodingOf<T>() || (!kIsString<T> && info.width != sizeof(T))) {
+                    throw std::runtime_error("Snapshot: column does not match the requested type");
+                }
+                bool const data_fits = kIsString<T> ? h.rows < UINT64_MAX && InFile(info.data_offset, h.rows + 1, sizeof(uint64_t), file.size())
+                                                    : InFile(info.data_offset, h.rows, sizeof(T), file.size());
+                if (info.data_offset % kAlignment != 0 || !data_fits || !InFile(info.heap_offset, info.heap_size, 1, file.size())) {
+                    throw std::runtime_error("Snapshot: column lies outside the file");
+                }
+                data_ = file.at(info.data_offset);
+                heap_ = reinterpret_cast<char const *>(file.at(info.heap_offset));
+                if constexpr (kIsString<T>) {
+                    uint64_t previous = Offset(0);
+                    if (previous != 0) {
+                        throw std::runtime_error("Snapshot: string offsets are corrupt");
+                    }
+                    for (uint64_t row = 1; row <= h.rows; ++row) {
+                        uint64_t const offset = Offset(row);
+                        if (offset < previous || offset > info.heap_size) {
+                            throw std::runtime_error("Snapshot: string offsets are corrupt");
+                        }
+                        previous = offset;
+                    }
+                    if (previous != info.heap_size) {
+                        throw std::runtime_error("Snapshot: string heap is truncated");
+                    }
+                }
+            }
+
+            value_type operator[](size_t row) const {
+                if constexpr (kIsString<T>) {
+                    uint64_t const first = Offset(row);
+                    return {heap_ + first, static_cast<size_t>(Offset(row + 1) - first)};
+                } else {
+                    T value;
+                    std::memcpy(&value, data_ + row * sizeof(T), sizeof(T));
+                    return value;
+                }
+            }
+
+        private:
+            uint64_t Offset(size_t i) const {
+                uint64_t offset;
+                std::memcpy(&offset, data_ + i * sizeof(uint64_t), sizeof offset);
+                return offset;
+            }
+        };
+    } // namespace Snapshot
+
+    // Writes every item of catalog to a snapshot file at path.
+    template <typename ItemType, template <typename> class DataContainer, typename Index>
+    void SaveCatalogSnapshot(std::string const &path, Catalog<ItemType, DataContainer, Index> const &catalog) {
+        // Iterating keeps this linear for containers without O(1) indexing.
+        std::vector<ItemType const *> items;
+        items.reserve(catalog.size());
+        for (auto const &item : catalog) {
+            items.push_back(&item);
+        }
+        Snapshot::WriteFile(path, Snapshot::Kind::Catalog, items.size(), [&](Snapshot::FileWriter &out) {
+            return Snapshot::WriteColumn<ItemType>(out, items.size(), [&](size_t row) -> ItemType const & { return *items[row]; });
+        });
+    }
+
+    // Writes a range of WarehouseInventory records to a snapshot file at path.
+    template <std::ranges::random_access_range Records>
+    void SaveInventorySnapshot(std::string const &path, Records const &records) {
+        using Record = std::ranges::range_value_t<Records>;
+        using Item = typename Record::Item;
+        using Location = typename Record::Location;
+        size_t const rows = std::ranges::size(records);
+        auto const first = std::ranges::begin(records);
+        Snapshot::WriteFile(
+            path, Snapshot::Kind::Inventory, rows,
+            [&](Snapshot::FileWriter &out) {
+                return Snapshot::WriteColumn<Item>(out, rows, [&](size_t row) -> Item const & { return first[row].item_name_; });
+            },
+            [&](Snapshot::FileWriter &out) {
+                return Snapshot::WriteColumn<Location>(out, rows, [&](size_t row) -> Location const & { return first[row].location_; });
+            });
+    }
+
+    // Read-only catalog over a snapshot written by SaveCatalogSnapshot.
+    // String items are returned as string_view into the mapped file. Copies
+    // share the mapping.
+    template <typename ItemType = std::string>
+    class CatalogView {
+        std::shared_ptr<Snapshot::MappedFile const> file_;
+        Snapshot::Column<ItemType> items_;
+        size_t size_ = 0;
+
+    public:
+        using Item = typename Snapshot::Column<ItemType>::value_type;
+
+        explicit CatalogView(std::string const &path)
+            : file_(std::make_shared<Snapshot::MappedFile const>(path, Snapshot::Kind::Catalog)),
+              items_(*file_, 0),
+              size_(file_->header().rows) {}
+
+        Item getItemAt(size_t i) const { return items_[i]; }
+        Item operator[](size_t i) const { return items_[i]; }
+
+        size_t size() const { return size_; }
+    };
+
+    // Read-only WarehouseInventory records over a snapshot written by
+    // SaveInventorySnapshot.
+    template <typename ItemType = std::string, typename LocationType = std::string>
+    class InventoryView {
+        std::shared_ptr<Snapshot::MappedFile const> file_;
+        Snapshot::Column<ItemType> items_;
+        Snapshot::Column<LocationType> locations_;
+        size_t size_ = 0;
+
+    public:
+        using Item = typename Snapshot::Column<ItemType>::value_type;
+        using Location = typename Snapshot::Column<LocationType>::value_type;
+
+        explicit InventoryView(std::string const &path)
+            : file_(std::make_shared<Snapshot::MappedFile const>(path, Snapshot::Kind::Inventory)),
+              items_(*file_, 0),
+              locations_(*file_, 1),
+              size_(file_->header().rows) {}
+
+        Item getItemName(size_t i) const { return items_[i]; }
+        Location getLocation(size_t i) const { return locations_[i]; }
+
+        // Copies record i out of the snapshot.
+        WarehouseInventory<ItemType, LocationType> record(size_t i) const {
+            return {ItemType(getItemName(i)), LocationType(getLocation(i))};
+        }
+
+        size_t size() const { return size_; }
+    };
+
+    // Formats inventory reports into one large buffer and hands it to the
+    // kernel with a single write() when it fills or on flush(). Numbers go
+    // through std::to_chars, and each record type's header line, with its
+    // typeid names, is built once and then copied. Output matches
+    // ShowInventoryDetails, except that floating-point values use the
+    // shortest form that round-trips.
+    class ReportWriter {
+        int fd_;
+        std::unique_ptr<char[]> buffer_;
+        size_t capacity_;
+        size_t used_ = 0;
+
+        // Room for the longest to_chars result of any arithmetic type.
+        static constexpr size_t kMaxNumber = 64;
+
+        template <typename T>
+        struct IsElectronics : std::false_type {};
+        template <typename LocationType>
+        struct IsElectronics<WarehouseInventory<std::pair<std::string, float>, LocationType>> : std::true_type {};
+
+        // The "Inventory Record" line for Record, built on first use.
+        template <typename Record>
+        static std::string_view Header() {
+            static std::string const header = std::string(IsElectronics<Record>::value ? "Inventory Record (ELECTRONICS ONLY)" : "Inventory Record") +
+                                              ": Item - " + typeid(typename Record::Item).name() + ", Location - " +
+                                              typeid(typename Record::Location).name() + "\n";
+            return header;
+        }
+
+        char *Reserve(size_t n) {
+            if (capacity_ - used_ < n) {
+                flush();
+            }
+            return buffer_.get() + used_;
+        }
+
+    public:
+        explicit ReportWriter(int fd, size_t capacity = size_t{1} << 20)
+            : fd_(fd), buffer_(std::make_unique<char[]>(std::max(capacity, kMaxNumber))), capacity_(std::max(capacity, kMaxNumber)) {}
+
+        ReportWriter(ReportWriter const &) = delete;
+        ReportWriter &operator=(ReportWriter const &) = delete;
+
+        ~ReportWriter() {
+            try {
+                flush();
+            } catch (std::system_error const &) {
+                // Nowhere to report it from a destructor; call flush() to see errors.
+            }
+        }
+
+        ReportWriter &append(std::string_view text) {
+            while (!text.empty()) {
+                Reserve(1);
+                size_t const n = std::min(text.size(), capacity_ - used_);
+                std::memcpy(buffer_.get() + used_, text.data(), n);
+                used_ += n;
+                text.remove_prefix(n);
+            }
+            return *this;
+        }
+
+        ReportWriter &append(char c) {
+            *Reserve(1) = c;
+            ++used_;
+            return *this;
+        }
+
+        // A template so that string literals do not decay to bool.
+        template <typename T>
+        requires std::is_arithmetic_v<T>
+        ReportWriter &append(T value) {
+            if constexpr (std::is_same_v<T, bool>) {
+                return append(value ? '1' : '0');
+            } else {
+                char *out = Reserve(kMaxNumber);
+                used_ = std::to_chars(out, out + kMaxNumber, value).ptr - buffer_.get();
+                return *this;
+            }
+        }
+
+        // The same lines as Record::ShowInventoryDetails(os, extras...).
+        template <typename Record, typename... Args>
+        void write_details(Args const &...extras) {
+            append(Header<Record>());
+            if constexpr (IsElectronics<Record>::value) {
+                static_assert(sizeof...(Args) == 2, "The electronics report takes two extra strings");
+                int line = 0;
+                ((append("Extra Info ").append(static_cast<char>('0' + ++line)).append(": ").append(std::string_view(extras)).append('\n')), ...);
+            } else {
+                ((append("Extra Item: ").append(extras).append('\n')), ...);
+            }
+        }
+
+        // Details for every record, with its item and location as the extras.
+        template <std::ranges::input_range Records>
+        void write_records(Records const &records) {
+            using Record = std::ranges::range_value_t<Records>;
+            std::string_view const header = Header<Record>();
+            for (auto const &record : records) {
+                append(header).append("Extra Item: ").append(record.item_name_).append("\nExtra Item: ").append(record.location_).append('\n');
+            }
+        }
+
+        // Writes out everything buffered.
+        void flush() {
+            size_t written = 0;
+            while (written < used_) {
+                ssize_t const n = ::write(fd_, buffer_.get() + written, used_ - written);
+                if (n < 0) {
+                    int const error = errno;
+                    if (error == EINTR) {
+                        continue;
+                    }
+                    used_ = 0;
+                    throw std::system_error(error, std::generic_category(), "ReportWriter: write failed");
+                }
+                written += static_cast<size_t>(n);
+            }
+            used_ = 0;
+        }
+    };
+
+    // Fixed set of worker threads for data-parallel queries. A job is split
+    // into chunks that the workers and the calling thread claim one at a
+    // time from a shared counter, so a thread that finishes early simply
+    // takes more chunks. One job runs at a time; a job must not submit
+    // another to the same pool.
+    class QueryPool {
+        struct Job {
+            std::function<void(size_t)> run_chunk;
+            size_t chunks;
+            std::atomic<size_t> next{0};
+            std::exception_ptr error;
+            std::mutex error_mutex;
+
+            Job(std::function<void(size_t)> body, size_t count) : run_chunk(std::move(body)), chunks(count) {}
+        };
+
+        std::vector<std::thread> workers_;
+        std::mutex submit_mutex_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable finished_;
+        Job *job_ = nullptr;
+        uint64_t generation_ = 0;
+        size_t active_ = 0;  // workers still inside the current job
+        bool stop_ = false;
+
+        static void Work(Job &job) {
+            for (size_t chunk; (chunk = job.next.fetch_add(1)) < job.chunks;) {
+                try {
+                    job.run_chunk(chunk);
+                } catch (...) {
+                    std::lock_guard lock(job.error_mutex);
+                    if (!job.error) {
+                        job.error = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        void WorkerLoop() {
+            uint64_t seen = 0;
+            std::unique_lock lock(mutex_);
+            while (true) {
+                // A worker that wakes after the job has finished skips it.
+                wake_.wait(lock, [&] { return stop_ || (job_ && generation_ != seen); });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+                Job *job = job_;
+                ++active_;
+                lock.unlock();
+                Work(*job);
+                lock.lock();
+                if (--active_ == 0) {
+                    finished_.notify_one();
+                }
+            }
+        }
+
+    public:
+        // threads counts the calling thread, so a pool of 1 runs inline.
+        explicit QueryPool(size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+            for (size_t i = 1; i < threads; ++i) {
+                workers_.emplace_back([this] { WorkerLoop(); });
+            }
+        }
+
+        QueryPool(QueryPool const &) = delete;
+        QueryPool &operator=(QueryPool const &) = delete;
+
+        ~QueryPool() {
+            {
+                std::lock_guard lock(mutex_);
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for (auto &worker : workers_) {
+                worker.join();
+            }
+        }
+
+        size_t concurrency() const { return workers_.size() + 1; }
+
+        // Calls body(chunk) for every chunk in [0, chunks) and returns when
+        // all have run. The first exception thrown by body is rethrown.
+        void run(size_t chunks, std::function<void(size_t)> body) {
+            std::lock_guard submit(submit_mutex_);
+            Job job(std::move(body), chunks);
+            if (!workers_.empty() && chunks > 1) {
+                {
+                    std::lock_guard lock(mutex_);
+                    job_ = &job;
+                    ++generation_;
+                }
+                wake_.notify_all();
+                Work(job);
+                std::unique_lock lock(mutex_);
+                finished_.wait(lock, [&] { return active_ == 0; });
+                job_ = nullptr;
+            } else {
+                Work(job);
+            }
+            if (job.error) {
+                std::rethrow_exception(job.error);
+            }
+        }
+
+        // Process-wide pool with one thread per hardware thread.
+        static QueryPool &Shared() {
+            static QueryPool pool;
+            return pool;
+        }
+    };
+
+    // Query algorithms over a Catalog. When the container is random access
+    // and indexing it hands out references, the items are split into chunks
+    // that run on a QueryPool; otherwise the query is a single sequential
+    // pass. Results come back in catalog order either way.
+    namespace Query {
+        template <typename CatalogType>
+        constexpr bool kParallel = std::ranges::random_access_range<typename CatalogType::Container const> &&
+                                   std::is_lvalue_reference_v<decltype(std::declval<CatalogType const &>()[size_t{0}])>;
+
+        // Below this many items per chunk the pool costs more than it saves.
+        inline constexpr size_t kMinChunk = 16 * 1024;
+
+        // Splits [0, n) into chunks and calls body(chunk, begin, end) for each.
+        template <typename Body>
+        size_t ForEachChunk(QueryPool &pool, size_t n, Body const &body) {
+            size_t const chunk_size = std::max(kMinChunk, n / (pool.concurrency() * 8) + 1);
+            size_t const chunks = (n + chunk_size - 1) / chunk_size;
+            pool.run(chunks, [&](size_t chunk) { body(chunk, chunk * chunk_size, std::min(n, (chunk + 1) * chunk_size)); });
+            return chunks;
+        }
+
+        template <typename CatalogType, typename Predicate>
+        size_t count_if(CatalogType const &catalog, Predicate pred, QueryPool &pool = QueryPool::Shared()) {
+            if constexpr (kParallel<CatalogType>) {
+                std::atomic<size_t> count{0};
+                ForEachChunk(pool, catalog.size(), [&](size_t, size_t begin, size_t end) {
+                    size_t local = 0;
+                    for (size_t i = begin; i < end; ++i) {
+                        local += static_cast<bool>(pred(catalog[i]));
+                    }
+                    count.fetch_add(local, std::memory_order_relaxed);
+                });
+                return count.load();
+            } else {
+                return static_cast<size_t>(std::count_if(catalog.begin(), catalog.end(), pred));
+            }
+        }
+
+        // reduce must be associative; partial results are combined in
+        // catalog order, so it need not be commutative.
+        template <typename CatalogType, typename T, typename Reduce, typename Transform>
+        T transform_reduce(CatalogType const &catalog, T init, Reduce reduce, Transform transform, QueryPool &pool = QueryPool::Shared()) {
+            if constexpr (kParallel<CatalogType>) {
+                std::vector<std::optional<T>> partials(catalog.size() / kMinChunk + 1);
+                size_t const chunks = ForEachChunk(pool, catalog.size(), [&](size_t chunk, size_t begin, size_t end) {
+                    T local = transform(catalog[begin]);
+                    for (size_t i = begin + 1; i < end; ++i) {
+                        local = reduce(std::move(local), transform(catalog[i]));
+                    }
+                    partials[chunk] = std::move(local);
+                });
+                for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                    init = reduce(std::move(init), std::move(*partials[chunk]));
+                }
+                return init;
+            } else {
+                for (auto const &item : catalog) {
+                    init = reduce(std::move(init), transform(item));
+                }
+                return init;
+            }
+        }
+
+        // Items for which pred holds, in catalog order.
+        template <typename CatalogType, typename Predicate>
+        std::vector<typename CatalogType::Item> filter(CatalogType const &catalog, Predicate pred, QueryPool &pool = QueryPool::Shared()) {
+            std::vector<typename CatalogType::Item> matches;
+            if constexpr (kParallel<CatalogType>) {
+                std::vector<std::vector<typename CatalogType::Item>> partials(catalog.size() / kMinChunk + 1);
+                size_t const chunks = ForEachChunk(pool, catalog.size(), [&](size_t chunk, size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        if (pred(catalog[i])) {
+                            partials[chunk].push_back(catalog[i]);
+                        }
+                    }
+                });
+                size_t total = 0;
+                for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                    total += partials[chunk].size();
+                }
+                matches.reserve(total);
+                for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                    std::move(partials[chunk].begin(), partials[chunk].end(), std::back_inserter(matches));
+                }
+            } else {
+                std::copy_if(catalog.begin(), catalog.end(), std::back_inserter(matches), pred);
+            }
+            return matches;
+        }
+
+        // Splits the items into those for which pred holds and the rest,
+        // each in catalog order. The catalog itself is left untouched, so
+        // positions (and any index over them) stay valid.
+        template <typename CatalogType, typename Predicate>
+        std::pair<std::vector<typename CatalogType::Item>, std::vector<typename CatalogType::Item>>
+        partition(CatalogType const &catalog, Predicate pred, QueryPool &pool = QueryPool::Shared()) {
+            using Items = std::vector<typename CatalogType::Item>;
+            std::pair<Items, Items> result;
+            if constexpr (kParallel<CatalogType>) {
+                // Mark each item, then size both outputs from per-chunk counts
+                // and copy every chunk to its final place in parallel.
+                size_t const n = catalog.size();
+                std::vector<uint8_t> keep(n);
+                std::vector<size_t> kept(n / kMinChunk + 2);
+                size_t const chunks = ForEachChunk(pool, n, [&](size_t chunk, size_t begin, size_t end) {
+                    size_t local = 0;
+                    for (size_t i = begin; i < end; ++i) {
+                        keep[i] = static_cast<bool>(pred(catalog[i]));
+                        local += keep[i];
+                    }
+                    kept[chunk + 1] = local;
+                });
+                std::partial_sum(kept.begin(), kept.begin() + chunks + 1, kept.begin());
+                result.first.resize(kept[chunks]);
+                result.second.resize(n - kept[chunks]);
+                ForEachChunk(pool, n, [&](size_t chunk, size_t begin, size_t end) {
+                    size_t in = kept[chunk];
+                    size_t out = begin - kept[chunk];
+                    for (size_t i = begin; i < end; ++i) {
+                        (keep[i] ? result.first[in++] : result.second[out++]) = catalog[i];
+                    }
+                });
+            } else {
+                std::partition_copy(catalog.begin(), catalog.end(), std::back_inserter(result.first), std::back_inserter(result.second), pred);
+            }
+            return result;
+        }
+    } // namespace Query
+
+    // Helper function to create some inventories.
+    template <typename ItemType, typename LocationType>
+    WarehouseInventory<ItemType, LocationType> CreateWarehouseItem(const ItemType &item, const LocationType &location) {
+        return {item, location};
+    }
+} // end of namespace InventorySystem
+
+namespace Tests {
+    template <typename T>
+    struct LinkedListDataContainer {
+        std::list<T> linked_list_;
+
+        void push_back(T const &x) {
+            linked_list_.push_back(x);
+        }
+
+        T operator[](int index) const {
+            auto it = linked_list_.begin();
+            std::advance(it, index);
+            return *it;
+        }
+
+        auto begin() const { return linked_list_.begin(); }
+        auto end() const { return linked_list_.end(); }
+
+        size_t size() const {
+            return linked_list_.size();
+        }
+
+        ~LinkedListDataContainer() = default;
+    };
+
+    void TestCatalog() {
+        // Using default template args
+        InventorySystem::Catalog catalog_default;
+
+        catalog_default.add_item("Washing machine");
+        catalog_default.add_item("Vacuum cleaner");
+
+        static_assert(std::is_same_v<decltype(catalog_default.getItemAt(0)), std::string>, "Item should be string");
+
+        if (catalog_default.getItemAt(0) == "Washing machine" && catalog_default.getItemAt(1) == "Vacuum cleaner") {
+            std::cout << "Default Catalog Test Passed" << std::endl;
+        } else {
+            throw std::runtime_error("Default Catalog Test failed");
+        }
+
+        // Providing ItemType but not Container type: should default to vector
+        InventorySystem::Catalog<int> catalog_int_default_container;
+        catalog_int_default_container.add_item(1);
+        catalog_int_default_container.add_item(2);
+
+        if (catalog_int_default_container.getItemAt(0) == 1 && catalog_int_default_container.getItemAt(1) == 2) {
+            std::cout << "Int catalog with default container Passed" << std::endl;
+        } else {
+            throw std::runtime_error("Int catalog with default container FAILED");
+        }
+
+        // Providing non-default Container: using a different data Container type (customized Data container type)
+        InventorySystem::Catalog<std::string, LinkedListDataContainer> catalog_with_custom_data_container;
+
+        catalog_with_custom_data_container.add_item("Refrigerator");
+        catalog_with_custom_data_container.add_item("Radio");
+
+        if (catalog_with_custom_data_container.getItemAt(0) == "Refrigerator" &&
+            catalog_with_custom_data_container.getItemAt(1) == "Radio") {
+            std::cout << "Custom container Data type Passed" << std::endl;
+        } else {
+            throw std::runtime_error("Custom container type test Failed");
+        }
+
+        // Testing that Data container is independent and items can be different for other datastructure
+        InventorySystem::Catalog<double, LinkedListDataContainer> double_catalog;
+        double_catalog.add_item(1.0);
+        double_catalog.add_item(2.0);
+
+        if (double_catalog.getItemAt(0) == 1.0 && double_catalog.getItemAt(1) == 2.0) {
+            std::cout << "Independent double linked list Passed" << std::endl;
+        } else {
+            throw std::runtime_error("Independent list failed");
+        }
+    }
+
+    void TestCatalogAccess() {
+        InventorySystem::Catalog catalog;
+        catalog.reserve(4);
+
+        std::string movable = "Television set with a walnut cabinet";
+        char const *const buffer = movable.data();
+        catalog.add_item(std::move(movable));
+        catalog.emplace_item(3, 'x');
+
+        static_assert(std::is_same_v<decltype(catalog[0]), std::string const &>, "operator[] should not copy");
+        if (catalog[0].data() != buffer || catalog[1] != "xxx") {
+            throw std::runtime_error("Catalog move/emplace test failed");
+        }
+
+        auto const items = catalog.items();
+        if (items.size() != 2 || &items[1] != &catalog[1]) {
+            throw std::runtime_error("Catalog span view test failed");
+        }
+
+        InventorySystem::Catalog<std::string, LinkedListDataContainer> list_catalog;
+        list_catalog.emplace_item("Radio");
+        list_catalog.add_item("Phonograph");
+        std::string joined;
+        for (auto const &item : list_catalog) {
+            joined += item;
+        }
+        if (joined != "RadioPhonograph" || list_catalog[1] != "Phonograph") {
+            throw std::runtime_error("Catalog iteration over a custom container failed");
+        }
+
+        // Containers that return items by value are passed through by value, not as dangling references.
+        static_assert(std::is_same_v<decltype(list_catalog[0]), std::string>);
+        InventorySystem::Catalog<bool> flags;
+        flags.add_item(true);
+        flags.add_item(false);
+        static_assert(!std::is_reference_v<decltype(flags[0])>);
+        if (!flags[0] || flags[1]) {
+            throw std::runtime_error("Catalog<bool> access failed");
+        }
+
+        std::cout << "Catalog zero-copy access Passed" << std::endl;
+    }
+
+    void TestInternedCatalog() {
+        auto interner = std::make_shared<InventorySystem::StringInterner>();
+        InventorySystem::InternedCatalog<> warehouse_a(interner);
+        InventorySystem::InternedCatalog<InventorySystem::ChunkedDataContainer> warehouse_b(interner);
+
+        auto const fridge = warehouse_a.add_item("Refrigerator");
+        warehouse_a.add_item("Radio");
+        warehouse_a.add_item("Refrigerator");
+        auto const fridge_b = warehouse_b.add_item(std::string("Refrigerator"));
+
+        if (fridge != fridge_b || interner->size() != 2 || warehouse_a.count("Refrigerator") != 2 || warehouse_a.count("Toaster") != 0) {
+            throw std::runtime_error("Interned catalog deduplication failed");
+        }
+
+        static_assert(std::is_same_v<decltype(warehouse_a.getItemAt(0)), std::string_view>, "Lookups should return string_view");
+        if (warehouse_a.getItemAt(1) != "Radio" || warehouse_b[0] != "Refrigerator") {
+            throw std::runtime_error("Interned catalog lookup failed");
+        }
+
+        // Enough distinct strings to grow the table and span several arena chunks.
+        InventorySystem::InternedCatalog<> large;
+        for (int i = 0; i < 20000; ++i) {
+            large.add_item("Part number " + std::to_string(i % 5000) + " of the 1950s radio line");
+        }
+        if (large.interner().size() != 5000 || large.getItemAt(19999) != "Part number 4999 of the 1950s radio line" ||
+            large.count("Part number 42 of the 1950s radio line") != 4) {
+            throw std::runtime_error("Interned catalog growth failed");
+        }
+
+        // The empty string first, before any chunk exists.
+        InventorySystem::StringInterner empty_first;
+        auto const empty = empty_first.intern("");
+        if (empty_first.intern("Dial") == empty || empty_first.view(empty) != "" || empty_first.intern("") != empty) {
+            throw std::runtime_error("Interning the empty string first failed");
+        }
+
+        // A string bigger than a chunk, then small ones that must land in a normal chunk.
+        InventorySystem::StringInterner oversized;
+        auto const small_before = oversized.intern("Knob");
+        std::string const manual(100 * 1024, 'x');
+        auto const big = oversized.intern(manual);
+        auto const small_after = oversized.intern("Speaker grille");
+        for (int i = 0; i < 5000; ++i) {
+            oversized.intern("Capacitor " + std::to_string(i));
+        }
+        if (oversized.view(big) != manual || oversized.view(small_before) != "Knob" || oversized.view(small_after) != "Speaker grille" ||
+            oversized.find("Capacitor 4999") == std::nullopt || oversized.view(*oversized.find("Capacitor 4999")) != "Capacitor 4999") {
+            throw std::runtime_error("Interning an oversized string failed");
+        }
+
+        std::cout << "Interned string catalog Passed" << std::endl;
+    }
+
+    // Counts live instances; copying throws once copies_left runs out.
+    struct Fragile {
+        static inline int live = 0;
+        static inline int copies_left = 0;
+        Fragile() { ++live; }
+        Fragile(Fragile const &) {
+            if (copies_left-- == 0) {
+                throw std::runtime_error("Fragile copy failed");
+            }
+            ++live;
+        }
+        ~Fragile() { --live; }
+    };
+
+    void TestChunkedDataContainer() {
+        static_assert(std::random_access_iterator<InventorySystem::ChunkedDataContainer<int>::iterator>);
+
+        InventorySystem::Catalog<std::string, InventorySystem::ChunkedDataContainer> catalog;
+        catalog.add_item("Toaster");
+        std::string const *first_address = &catalog.item_list_[0];
+
+        // Cross several block boundaries.
+        size_t const count = 3 * InventorySystem::ChunkedDataContainer<std::string>::block_size + 7;
+        for (size_t i = 1; i < count; ++i) {
+            catalog.add_item("Item " + std::to_string(i));
+        }
+
+        if (catalog.size() != count || catalog.getItemAt(0) != "Toaster" || catalog.getItemAt(count - 1) != "Item " + std::to_string(count - 1)) {
+            throw std::runtime_error("Chunked container Catalog test failed");
+        }
+
+        if (&catalog.item_list_[0] != first_address) {
+            throw std::runtime_error("Chunked container moved an element while growing");
+        }
+
+        auto const &items = catalog.item_list_;
+        if (std::find(items.begin(), items.end(), "Item 2000") - items.begin() != 2000) {
+            throw std::runtime_error("Chunked container iteration failed");
+        }
+
+        InventorySystem::ChunkedDataContainer<std::string> copy = catalog.item_list_;
+        if (copy.size() != count || copy[count - 1] != catalog.getItemAt(count - 1)) {
+            throw std::runtime_error("Chunked container copy failed");
+        }
+
+        // A copy that throws partway destroys the elements it already made.
+        {
+            InventorySystem::ChunkedDataContainer<Fragile, 4> fragile;
+            for (int i = 0; i < 10; ++i) {
+                fragile.emplace_back();
+            }
+            Fragile::copies_left = 6;
+            bool threw = false;
+            try {
+                InventorySystem::ChunkedDataContainer<Fragile, 4> partial(fragile);
+            } catch (std::runtime_error const &) {
+                threw = true;
+            }
+            if (!threw || Fragile::live != 10) {
+                throw std::runtime_error("Chunked container leaked elements from a failed copy");
+            }
+        }
+
+        std::cout << "Chunked container Catalog Passed" << std::endl;
+    }
+
+    void TestConcurrentCatalog() {
+        InventorySystem::ConcurrentCatalog<std::string> catalog;
+        constexpr int kWriters = 4;
+        constexpr int kPerWriter = 5000;
+        std::atomic<bool> reader_failed{false};
+        std::atomic<bool> done{false};
+
+        // A reader checks every visible item while the writers run.
+        std::thread reader([&] {
+            while (!done.load()) {
+                size_t const visible = catalog.size();
+                for (size_t i = 0; i < visible; ++i) {
+                    if (catalog[i].rfind("Writer ", 0) != 0) {
+                        reader_failed = true;
+                    }
+                }
+            }
+        });
+
+        std::vector<std::thread> writers;
+        for (int w = 0; w < kWriters; ++w) {
+            writers.emplace_back([&catalog, w] {
+                for (int i = 0; i < kPerWriter; ++i) {
+                    catalog.add_item("Writer " + std::to_string(w) + " item " + std::to_string(i));
+                }
+            });
+        }
+        for (auto &writer : writers) {
+            writer.join();
+        }
+        done = true;
+        reader.join();
+
+        if (reader_failed || catalog.size() != kWriters * kPerWriter) {
+            throw std::runtime_error("Concurrent catalog test failed");
+        }
+
+        std::vector<std::string> items;
+        for (size_t i = 0; i < catalog.size(); ++i) {
+            items.push_back(catalog.getItemAt(i));
+        }
+        std::sort(items.begin(), items.end());
+        if (std::adjacent_find(items.begin(), items.end()) != items.end()) {
+            throw std::runtime_error("Concurrent catalog stored an item twice");
+        }
+
+        // An item whose constructor throws claims no index, so later items still become visible.
+        InventorySystem::ConcurrentCatalog<std::string> partial;
+        partial.add_item("Before");
+        bool threw = false;
+        try {
+            partial.emplace_item(std::string("short"), 10);  // substring position past the end
+        } catch (std::out_of_range const &) {
+            threw = true;
+        }
+        partial.add_item("After");
+        if (!threw || partial.size() != 2 || partial[1] != "After") {
+            throw std::runtime_error("Concurrent catalog did not recover from a throwing constructor");
+        }
+
+        std::cout << "Concurrent append-only catalog Passed" << std::endl;
+    }
+
+    void TestCatalogIndex() {
+        InventorySystem::Catalog<std::string, std::vector, InventorySystem::SwissIndex<std::string>> catalog;
+        catalog.add_item("Radio");
+        catalog.emplace_item(3, 'x');
+        catalog.add_item(std::string("Toaster"));
+        catalog.add_item("Radio");
+
+        if (catalog.find("Radio") != 0 || catalog.find("xxx") != 1 || catalog.find("Toaster") != 2 || catalog.find("Kettle")) {
+            throw std::runtime_error("Catalog index lookup failed");
+        }
+
+        // Grow through several rehashes, with and without reserve, and check
+        // the index agrees with a scan of every container kind.
+        InventorySystem::Catalog<int, std::vector, InventorySystem::SwissIndex<int>> grown;
+        InventorySystem::Catalog<int, InventorySystem::ChunkedDataContainer, InventorySystem::SwissIndex<int>> chunked;
+        InventorySystem::Catalog<int, LinkedListDataContainer, InventorySystem::SwissIndex<int>> linked;
+        InventorySystem::Catalog<int, std::vector> unindexed;
+        chunked.reserve(3000);
+        for (int i = 0; i < 5000; ++i) {
+            int const item = (i * 7) % 3000;
+            grown.add_item(item);
+            chunked.add_item(item);
+            unindexed.add_item(item);
+            if (i < 500) {
+                linked.add_item(item);
+            }
+        }
+        for (int item = -1; item <= 3000; ++item) {
+            auto const expected = unindexed.find(item);
+            if (grown.find(item) != expected || chunked.find(item) != expected) {
+                throw std::runtime_error("Catalog index disagrees with a linear scan");
+            }
+        }
+        if (linked.find(3493 % 3000) != 499 || linked.find(1)) {
+            throw std::runtime_error("Catalog index over a linked list failed");
+        }
+
+        // An index that rejects an item must not leave it in the catalog.
+        struct RejectingIndex : InventorySystem::NoIndex {
+            void insert(std::vector<int> const &, int item, size_t) {
+                if (item < 0) {
+                    throw std::invalid_argument("negative item");
+                }
+            }
+        };
+        InventorySystem::Catalog<int, std::vector, RejectingIndex> rejecting;
+        rejecting.add_item(1);
+        try {
+            rejecting.add_item(-1);
+            throw std::runtime_error("Catalog accepted an item its index rejected");
+        } catch (std::invalid_argument const &) {
+        }
+        if (rejecting.size() != 1 || rejecting.find(-1)) {
+            throw std::runtime_error("Catalog kept an item its index rejected");
+        }
+
+        std::cout << "Hashed Catalog index Passed" << std::endl;
+    }
+
+    void TestRcuCatalog() {
+        InventorySystem::RcuCatalog<int> catalog;
+        std::atomic<bool> done{false};
+        std::atomic<bool> failed{false};
+
+        // Every snapshot must be a prefix 0, 1, 2, ... that does not change
+        // while it is held, whatever the writer does meanwhile.
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; ++r) {
+            readers.emplace_back([&] {
+                auto reader = catalog.reader();
+                while (!done.load()) {
+                    auto const snapshot = reader.snapshot();
+                    size_t const size = snapshot.size();
+                    for (size_t i = size > 3000 ? size - 3000 : 0; i < size; ++i) {
+                        if (snapshot[i] != static_cast<int>(i)) {
+                            failed = true;
+                        }
+                    }
+                    if (snapshot.size() != size) {
+                        failed = true;
+                    }
+                }
+            });
+        }
+
+        std::vector<int> batch(500);
+        int next = 0;
+        for (int round = 0; round < 100; ++round) {
+            for (int i = 0; i < 500; ++i) {
+                catalog.add_item(next++);
+            }
+            std::iota(batch.begin(), batch.end(), next);
+            catalog.add_items(batch);
+            next += 500;
+        }
+        done = true;
+        for (auto &reader : readers) {
+            reader.join();
+        }
+
+        {
+            auto const reader = catalog.reader();
+            auto const snapshot = reader.snapshot();
+            if (failed || snapshot.size() != 100'000 || snapshot.getItemAt(99'999) != 99'999) {
+                throw std::runtime_error("RCU catalog snapshot test failed");
+            }
+        }
+
+        // With no reader pinned, two more writes reclaim every old version.
+        catalog.add_item(next++);
+        catalog.add_item(next++);
+        if (catalog.pending_reclaim() > 2) {
+            throw std::runtime_error("RCU catalog did not reclaim old versions");
+        }
+
+        // A batch that fails right after growing a table it staged itself
+        // keeps what it added, frees everything else, and can be retried.
+        {
+            size_t const failing = 2 * 16 * 1024;
+            std::vector<Fragile> fragile(failing + 1);
+            InventorySystem::RcuCatalog<Fragile> partial;
+            Fragile::copies_left = static_cast<int>(2 * failing + 1);  // converted, then moved in
+            try {
+                partial.add_items(fragile);
+                throw std::logic_error("RCU catalog batch did not throw");
+            } catch (std::runtime_error const &) {
+            }
+            Fragile::copies_left = 1;
+            partial.add_item(Fragile());
+            auto const reader = partial.reader();
+            if (reader.snapshot().size() != failing + 1) {
+                throw std::runtime_error("RCU catalog lost items from a failed batch");
+            }
+        }
+        if (Fragile::live != 0) {
+            throw std::runtime_error("RCU catalog leaked items from a failed batch");
+        }
+
+        std::cout << "RCU snapshot catalog Passed" << std::endl;
+    }
+
+    void TestQueries() {
+        InventorySystem::QueryPool pool(4);
+        InventorySystem::Catalog<int64_t> catalog;
+        InventorySystem::Catalog<int64_t, InventorySystem::ChunkedDataContainer> chunked;
+        InventorySystem::Catalog<int64_t, LinkedListDataContainer> linked;
+        for (int64_t i = 0; i < 200'000; ++i) {
+            catalog.add_item(i);
+            chunked.add_item(i);
+            if (i < 1000) {
+                linked.add_item(i);
+            }
+        }
+        static_assert(InventorySystem::Query::kParallel<decltype(chunked)> && !InventorySystem::Query::kParallel<decltype(linked)>);
+        // std::vector<bool> is random access but indexes by value.
+        static_assert(!InventorySystem::Query::kParallel<InventorySystem::Catalog<bool>>);
+
+        auto const multiple_of_7 = [](int64_t x) { return x % 7 == 0; };
+        auto check = [&](auto const &c, int64_t n) {
+            auto const matches = InventorySystem::Query::filter(c, multiple_of_7, pool);
+            auto const [multiples, rest] = InventorySystem::Query::partition(c, multiple_of_7, pool);
+            // Concatenating strings checks that partial results combine in order.
+            auto const digits = InventorySystem::Query::transform_reduce(
+                c, std::string(), std::plus<>(), [](int64_t x) { return std::to_string(x % 10); }, pool);
+            size_t const expected = static_cast<size_t>((n + 6) / 7);
+            if (InventorySystem::Query::count_if(c, multiple_of_7, pool) != expected || matches.size() != expected ||
+                matches.back() != (n - 1) / 7 * 7 || multiples != matches || rest.size() != n - expected || rest[5] != 6 ||
+                digits.size() != static_cast<size_t>(n) || digits.substr(0, 12) != "012345678901" ||
+                InventorySystem::Query::transform_reduce(c, int64_t{0}, std::plus<>(), [](int64_t x) { return x; }, pool) != n * (n - 1) / 2) {
+                throw std::runtime_error("Catalog query results are wrong");
+            }
+        };
+        check(catalog, 200'000);
+        check(chunked, 200'000);
+        check(linked, 1000);
+
+        bool rethrown = false;
+        try {
+            InventorySystem::Query::count_if(catalog, [](int64_t x) {
+                if (x == 123'456) {
+                    throw std::runtime_error("predicate failed");
+                }
+                return true;
+            }, pool);
+        } catch (std::runtime_error const &) {
+            rethrown = true;
+        }
+        if (!rethrown) {
+            throw std::runtime_error("Catalog query lost an exception");
+        }
+
+        std::cout << "Parallel catalog queries Passed" << std::endl;
+    }
+
+    void TestWarehouseInventory() {
+        // Default creation
+        InventorySystem::WarehouseInventory item1;
+
+        std::cout << "Warehouse Inventory Type: " << typeid(item1).name() << std::endl;
+
+        // Item, Location Default to string: Default creation.
+        auto inventory1 = InventorySystem::CreateWarehouseItem(std::string("Iron"), std::string("Warehouse A"));
+        static_assert(std::is_same_v<decltype(inventory1.getItemName()), std::string>, "Item should be default string");
+
+        if (inventory1.getItemName() == "Iron" && inventory1.getLocation() == "Warehouse A") {
+            std::cout << "Inventory Creation, Defaults Pass: " << inventory1.getItemName() << " located at " << inventory1.getLocation() << std::endl;
+        } else {
+            throw std::runtime_error("Inventory Creation, Defaults fail");
+        }
+
+        // Non-default parameters but default type for locations
+        InventorySystem::WarehouseInventory<int> inventory2(121, "Warehouse B");
+        static_assert(std::is_same_v<decltype(inventory2.getItemName()), int>, "Item should be int");
+
+        if (inventory2.getItemName() == 121 && inventory2.getLocation() == "Warehouse B") {
+            std::cout << "Inventory Creation Type parameter, String Location Type Passed: " << inventory2.getItemName() << " located at " << inventory2.getLocation() << std::endl;
+        } else {
+            throw std::runtime_error("Creation with type passed but default string fail");
+        }
+
+        // Fully type specification
+        InventorySystem::WarehouseInventory<float, int> inventory3(12.3f, 4345);
+
+        if (inventory3.getItemName() == 12.3f && inventory3.getLocation() == 4345) {
+            std::cout << "Inventory Creation, fully Type Parameters Pass: " << inventory3.getItemName() << " location " << inventory3.getLocation() << std::endl;
+        } else {
+            throw std::runtime_error("Fully Type Inventory creation fails");
+        }
+
+        InventorySystem::WarehouseInventory<int, int> inv_test{1, 2};
+
+        static_assert(std::is_same_v<decltype(inv_test.getItemName()), int>, "Type should be int for Item");
+        static_assert(std::is_same_v<decltype(inv_test.getLocation()), int>, "Type should be int for Location");
+
+        std::cout << "Item test item, Location, Int type parameters passed: Item name: " << inv_test.getItemName() << " Location: " << inv_test.getLocation() << std::endl;
+
+        // Test Partial specialization
+        InventorySystem::WarehouseInventory<std::pair<std::string, float>, std::string> electronic_inventory({"Transistor", 1.0}, "Warehouse C", 3);
+
+        // This check should pass for base class
+        InventorySystem::WarehouseInventory<std::pair<std::string, float>, std::string>::ShowInventoryDetails(std::cout, "Extra info1", "Extra Info2");
+
+        static_assert(std::is_same_v<decltype(electronic_inventory.item_name_), std::pair<std::string, float>>, "Item should be a pair");
+
+        if (electronic_inventory.item_name_.first == "Transistor" && electronic_inventory.getShelfNumber() == 3) {
+            std::cout << "Partial Specialization works: Item name " << electronic_inventory.item_name_.first << ", Shelf: " << electronic_inventory.getShelfNumber() << std::endl;
+        } else {
+            throw std::runtime_error("Partial Specialization does not match");
+        }
+    }
+
+    void TestInventoryTable() {
+        InventorySystem::InventoryTable<int> table;
+        std::vector<InventorySystem::WarehouseInventory<int>> records;
+        char const *warehouses[] = {"Warehouse A", "Warehouse B", "Dock 7", "Warehouse A", "Dock 7", "Warehouse A"};
+        for (int i = 0; i < 1003; ++i) {
+            records.emplace_back(i, warehouses[i % 6]);
+            table.add_record(records.back());
+        }
+
+        if (table.size() != records.size() || table.locations().size() != 3 || table.item(500) != 500 || table.location(500) != "Dock 7") {
+            throw std::runtime_error("Inventory table load failed");
+        }
+
+        for (auto const *warehouse : {"Warehouse A", "Warehouse B", "Dock 7", "Warehouse Z"}) {
+            std::vector<uint32_t> expected;
+            for (uint32_t row = 0; row < records.size(); ++row) {
+                if (records[row].getLocation() == warehouse) {
+                    expected.push_back(row);
+                }
+            }
+            if (table.select_at(warehouse) != expected || table.count_at(warehouse) != expected.size()) {
+                throw std::runtime_error("Inventory table select by location failed");
+            }
+        }
+
+        auto const counts = table.group_counts();
+        if (counts[*table.location_code("Warehouse A")] != 502 || counts[*table.location_code("Warehouse B")] != 167 ||
+            counts[*table.location_code("Dock 7")] != 334) {
+            throw std::runtime_error("Inventory table group counts failed");
+        }
+
+        if (table.record(1000).getItemName() != 1000 || table.record(1000).getLocation() != "Dock 7") {
+            throw std::runtime_error("Inventory table record reconstruction failed");
+        }
+
+        std::cout << "Columnar inventory table Passed" << std::endl;
+    }
+
+    void TestLocationIndex() {
+        static_assert(std::forward_iterator<InventorySystem::BPlusTree<int, int>::Iterator>);
+
+        // Against std::multimap, with few distinct keys so duplicates span
+        // several leaves, and with a small fanout so the tree grows tall.
+        InventorySystem::BPlusTree<int, int, 4> tree;
+        std::multimap<int, int> reference;
+        uint32_t state = 1;
+        auto next = [&state] { return state = state * 1103515245u + 12345u, static_cast<int>((state >> 8) % 1000); };
+        for (int i = 0; i < 20000; ++i) {
+            int const key = next() % 300;
+            tree.insert(key, i);
+            reference.emplace(key, i);
+            if (i % 3 == 0) {
+                int const victim = next() % 300;
+                auto const it = reference.find(victim);
+                bool const erased = tree.erase(victim, it == reference.end() ? -1 : it->second);
+                if (erased != (it != reference.end())) {
+                    throw std::runtime_error("B+-tree erase failed");
+                }
+                if (it != reference.end()) {
+                    reference.erase(it);
+                }
+            }
+        }
+        if (tree.size() != reference.size() || tree.height() < 4 ||
+            !std::equal(tree.begin(), tree.end(), reference.begin(), reference.end(), [](int a, auto const &b) { return a == b.second; })) {
+            throw std::runtime_error("B+-tree contents differ from std::multimap");
+        }
+        for (int key = -1; key <= 300; key += 7) {
+            auto const [first, last] = reference.equal_range(key);
+            auto const found = tree.equal_range(key);
+            if (!std::equal(found.begin(), found.end(), first, last, [](int a, auto const &b) { return a == b.second; }) ||
+                tree.count(key) != reference.count(key)) {
+                throw std::runtime_error("B+-tree lookup failed");
+            }
+        }
+        auto const between = tree.range(40, 90);
+        if (!std::equal(between.begin(), between.end(), reference.lower_bound(40), reference.lower_bound(90),
+                        [](int a, auto const &b) { return a == b.second; })) {
+            throw std::runtime_error("B+-tree range scan failed");
+        }
+
+        std::vector<InventorySystem::WarehouseInventory<int>> records;
+        for (auto const *location : {"Dock-7A", "Warehouse A", "Dock-71", "Dock-8", "Warehouse F", "Warehouse G", "Dock-7A"}) {
+            records.emplace_back(static_cast<int>(records.size()), location);
+        }
+        InventorySystem::LocationIndex<int> index;
+        for (auto const &record : records) {
+            index.add(record);
+        }
+        auto items = [](auto const &range) {
+            std::vector<int> out;
+            for (auto const *record : range) {
+                out.push_back(record->getItemName());
+            }
+            return out;
+        };
+        if (items(index.with_prefix("Dock-7")) != std::vector{2, 0, 6} || items(index.between("Warehouse A", "Warehouse G")) != std::vector{1, 4} ||
+            items(index.at("Dock-7A")) != std::vector{0, 6} || !index.with_prefix("Yard").empty()) {
+            throw std::runtime_error("Location index queries failed");
+        }
+        index.remove(records[0]);
+        if (items(index.at("Dock-7A")) != std::vector{6} || index.size() != records.size() - 1) {
+            throw std::runtime_error("Location index removal failed");
+        }
+
+        std::cout << "B+-tree location index Passed" << std::endl;
+    }
+
+    void TestSnapshots() {
+        auto const directory = std::filesystem::temp_directory_path();
+        std::string const catalog_path = (directory / ("n217_catalog_" + std::to_string(::getpid()) + ".snap")).string();
+        std::string const inventory_path = (directory / ("n217_inventory_" + std::to_string(::getpid()) + ".snap")).string();
+
+        InventorySystem::Catalog<std::string, LinkedListDataContainer> catalog;
+        catalog.add_item("Washing machine");
+        catalog.add_item("");
+        catalog.add_item("Vacuum cleaner");
+        InventorySystem::SaveCatalogSnapshot(catalog_path, catalog);
+        {
+            InventorySystem::CatalogView view(catalog_path);
+            static_assert(std::is_same_v<decltype(view[0]), std::string_view>, "String items should be views into the file");
+            if (view.size() != 3 || view[0] != "Washing machine" || view[1] != "" || view.getItemAt(2) != "Vacuum cleaner") {
+                throw std::runtime_error("Catalog snapshot round trip failed");
+            }
+        }
+
+        std::vector<InventorySystem::WarehouseInventory<int>> records;
+        for (int i = 0; i < 1000; ++i) {
+            records.emplace_back(i * 3, "Warehouse " + std::to_string(i % 7));
+        }
+        InventorySystem::SaveInventorySnapshot(inventory_path, records);
+        InventorySystem::InventoryView<int> inventory(inventory_path);
+        if (inventory.size() != records.size() || inventory.getItemName(999) != 2997 || inventory.getLocation(999) != "Warehouse 5" ||
+            inventory.record(10).getLocation() != records[10].getLocation()) {
+            throw std::runtime_error("Inventory snapshot round trip failed");
+        }
+
+        // Wrong kind, wrong column type and a damaged header are all rejected.
+        auto rejects = [](auto open) {
+            try {
+                open();
+            } catch (std::runtime_error const &) {
+                return true;
+            }
+            return false;
+        };
+        bool const rejected = rejects([&] { InventorySystem::CatalogView<> view(inventory_path); }) &&
+                              rejects([&] { InventorySystem::InventoryView<int64_t> view(inventory_path); }) &&
+                              rejects([&] { InventorySystem::CatalogView<> view(directory / "n217_missing.snap"); });
+        std::FILE *file = std::fopen(catalog_path.c_str(), "r+b");
+        std::fputc('X', file);
+        std::fclose(file);
+        if (!rejected || !rejects([&] { InventorySystem::CatalogView<> view(catalog_path); })) {
+            throw std::runtime_error("Snapshot validation failed");
+        }
+
+        // Corrupt sizes and offsets that would otherwise wrap around or
+        // send operator[] outside the mapping.
+        using InventorySystem::Snapshot::Header;
+        auto damaged = [&](size_t offset, uint64_t value) {
+            InventorySystem::SaveCatalogSnapshot(catalog_path, catalog);
+            std::FILE *damage = std::fopen(catalog_path.c_str(), "r+b");
+            std::fseek(damage, static_cast<long>(offset), SEEK_SET);
+            std::fwrite(&value, sizeof value, 1, damage);
+            std::fclose(damage);
+            return rejects([&] { InventorySystem::CatalogView<> view(catalog_path); });
+        };
+        size_t const column = offsetof(Header, columns);
+        constexpr size_t alignment = InventorySystem::Snapshot::kAlignment;
+        size_t const data = (sizeof(Header) + alignment - 1) / alignment * alignment;  // the only column follows the header
+        if (!damaged(offsetof(Header, rows), uint64_t{1} << 61) || !damaged(offsetof(Header, rows), UINT64_MAX) ||
+            !damaged(column + offsetof(InventorySystem::Snapshot::ColumnInfo, heap_offset), UINT64_MAX - 8) ||
+            !damaged(column + offsetof(InventorySystem::Snapshot::ColumnInfo, data_offset), UINT64_MAX - 63) ||
+            !damaged(data + sizeof(uint64_t), 20) ||          // row 0 ends past row 1
+            !damaged(data + 2 * sizeof(uint64_t), 1 << 20)) {  // row 1 ends past the heap
+            throw std::runtime_error("Snapshot offset validation failed");
+        }
+
+        std::filesystem::remove(catalog_path);
+        std::filesystem::remove(inventory_path);
+        std::cout << "Binary snapshots Passed" << std::endl;
+    }
+
+    void TestReportWriter() {
+        using Record = InventorySystem::WarehouseInventory<int>;
+        using Electronics = InventorySystem::WarehouseInventory<std::pair<std::string, float>, std::string>;
+        std::vector<Record> records;
+        for (int i = 0; i < 40; ++i) {
+            records.emplace_back(i * -37, "Warehouse " + std::to_string(i));
+        }
+
+        std::ostringstream expected;
+        Record::ShowInventoryDetails(expected, 7, "Shelf", 2.5, 'x', 12345678901LL, true);
+        Electronics::ShowInventoryDetails(expected, "Extra info1", "Extra Info2");
+        for (auto const &record : records) {
+            Record::ShowInventoryDetails(expected, record.item_name_, record.location_);
+        }
+
+        // A tiny buffer so that records straddle several flushes.
+        int fds[2];
+        if (::pipe(fds) != 0) {
+            throw std::system_error(errno, std::generic_category(), "pipe");
+        }
+        {
+            InventorySystem::ReportWriter writer(fds[1], 100);
+            writer.write_details<Record>(7, "Shelf", 2.5, 'x', 12345678901LL, true);
+            writer.write_details<Electronics>("Extra info1", "Extra Info2");
+            writer.write_records(records);
+        }
+        ::close(fds[1]);
+        std::string actual;
+        char chunk[4096];
+        for (ssize_t n; (n = ::read(fds[0], chunk, sizeof chunk)) > 0;) {
+            actual.append(chunk, static_cast<size_t>(n));
+        }
+        ::close(fds[0]);
+
+        if (actual != expected.str()) {
+            throw std::runtime_error("Report writer output differs from ShowInventoryDetails");
+        }
+
+        std::cout << "Buffered report writer Passed" << std::endl;
+    }
+
+    // Counts what reaches an upstream resource.
+    class CountingResource : public std::pmr::memory_resource {
+        std::pmr::memory_resource *upstream_ = std::pmr::new_delete_resource();
+
+        void *do_allocate(size_t bytes, size_t alignment) override {
+            ++allocations;
+            return upstream_->allocate(bytes, alignment);
+        }
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override { upstream_->deallocate(p, bytes, alignment); }
+        bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override { return this == &other; }
+
+    public:
+        size_t allocations = 0;
+    };
+
+    void TestPmrAllocation() {
+        static_assert(std::uses_allocator_v<InventorySystem::PmrWarehouseInventory, std::pmr::polymorphic_allocator<InventorySystem::PmrWarehouseInventory>>);
+        static_assert(!std::uses_allocator_v<InventorySystem::WarehouseInventory<>, std::pmr::polymorphic_allocator<InventorySystem::WarehouseInventory<>>>);
+        static_assert(!std::uses_allocator_v<InventorySystem::WarehouseInventory<int>, std::pmr::polymorphic_allocator<InventorySystem::WarehouseInventory<int>>>);
+
+        std::string const long_name = "A name much too long for the small string buffer";
+        CountingResource counting;
+        {
+            InventorySystem::Catalog<std::pmr::string, InventorySystem::PmrVector> catalog(&counting);
+            catalog.add_item(std::pmr::string(long_name));
+            catalog.emplace_item(long_name);
+            if (catalog.getItemAt(1) != long_name.c_str() || catalog.item_list_[0].get_allocator().resource() != &counting ||
+                catalog.item_list_[1].get_allocator().resource() != &counting) {
+                throw std::runtime_error("pmr Catalog did not use its resource");
+            }
+
+            std::pmr::vector<InventorySystem::PmrWarehouseInventory> records(&counting);
+            records.emplace_back(long_name.c_str(), "Warehouse with a long descriptive name");
+            records.push_back(InventorySystem::CreateWarehouseItem(std::pmr::string(long_name), std::pmr::string("Dock")));
+            records.reserve(10);  // moves the records into new storage from the same resource
+            for (auto const &record : records) {
+                if (record.item_name_.get_allocator().resource() != &counting || record.getItemName() != long_name.c_str()) {
+                    throw std::runtime_error("pmr WarehouseInventory did not use its container's resource");
+                }
+            }
+        }
+        if (counting.allocations == 0) {
+            throw std::runtime_error("pmr resource was not used");
+        }
+
+        // Everything for a batch comes from one arena, which is released at once.
+        CountingResource upstream;
+        std::pmr::monotonic_buffer_resource arena(1 << 16, &upstream);
+        {
+            std::pmr::vector<InventorySystem::PmrWarehouseInventory> batch(&arena);
+            for (int i = 0; i < 1000; ++i) {
+                batch.emplace_back(long_name + std::to_string(i), "Warehouse " + std::to_string(i % 5) + " on the far side of town");
+            }
+        }
+        arena.release();
+        if (upstream.allocations > 10) {
+            throw std::runtime_error("Arena made too many upstream allocations");
+        }
+
+        std::cout << "pmr Catalog and WarehouseInventory Passed" << std::endl;
+    }
+
+    void RunTests() {
+        TestCatalog();
+        TestCatalogAccess();
+        TestCatalogIndex();
+        TestChunkedDataContainer();
+        TestInternedCatalog();
+        TestConcurrentCatalog();
+        TestRcuCatalog();
+        TestQueries();
+        TestWarehouseInventory();
+        TestInventoryTable();
+        TestLocationIndex();
+        TestSnapshots();
+        TestReportWriter();
+        TestPmrAllocation();
+
+        std::cout << "All tests Completed Successfully" << std::endl;
+    }
+} // namespace Tests
+
+namespace Benchmarks {
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Fills a catalog with n items, then scans it through getItemAt. The
+    // slowest single add_item shows the reallocation-copy spikes.
+    template <template <typename> class DataContainer>
+    void BenchCatalogContainer(char const *label, size_t n, size_t scan_limit) {
+        InventorySystem::Catalog<int64_t, DataContainer> catalog;
+        auto start = Clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            catalog.add_item(static_cast<int64_t>(i));
+        }
+        double const add_ms = ElapsedMs(start);
+
+        double worst_add_us = 0.0;
+        {
+            InventorySystem::Catalog<int64_t, DataContainer> timed;
+            for (size_t i = 0; i < n; ++i) {
+                auto const before = Clock::now();
+                timed.add_item(static_cast<int64_t>(i));
+                worst_add_us = std::max(worst_add_us, std::chrono::duration<double, std::micro>(Clock::now() - before).count());
+            }
+        }
+
+        size_t const scanned = std::min(n, scan_limit);
+        int64_t checksum = 0;
+        start = Clock::now();
+        for (size_t i = 0; i < scanned; ++i) {
+            checksum += catalog.getItemAt(i);
+        }
+        double const scan_ms = ElapsedMs(start);
+
+        std::cout << label << "add " << add_ms * 1e6 / n << " ns/item (worst " << worst_add_us << " us), scan "
+                  << scan_ms * 1e6 / scanned << " ns/item over " << scanned << " items (checksum " << checksum << ")" << std::endl;
+    }
+
+    void BenchChunkedContainer() {
+        constexpr size_t n = 10'000'000;
+
+        std::cout << "\n--- Catalog<int64_t> containers, " << n << " items ---" << std::endl;
+        BenchCatalogContainer<std::vector>("std::vector:            ", n, n);
+        BenchCatalogContainer<InventorySystem::ChunkedDataContainer>("ChunkedDataContainer:   ", n, n);
+        // getItemAt walks the list from the front, so a full scan is O(n^2).
+        BenchCatalogContainer<Tests::LinkedListDataContainer>("LinkedListDataContainer:", n, 20'000);
+    }
+
+    // Loading and scanning a Catalog<std::pmr::string> through the copying
+    // API (add_item(const&), getItemAt) against the zero-copy one (reserve,
+    // add_item(&&), operator[] / range-for). The default memory resource is
+    // swapped for a counting one, so every string and vector allocation made
+    // along the way, including getItemAt's copies, is counted.
+    void BenchCatalogAccess() {
+        constexpr size_t n = 2'000'000;
+        using Catalog = InventorySystem::Catalog<std::pmr::string, InventorySystem::PmrVector>;
+        std::vector<std::pmr::string> feed(n);
+        for (size_t i = 0; i < n; ++i) {
+            feed[i] = "Warehouse item number " + std::to_string(i);
+        }
+
+        auto report = [](char const *label, size_t allocations, double ms) {
+            std::cout << label << static_cast<double>(allocations) / n << " allocations/item, " << ms * 1e6 / n << " ns/item" << std::endl;
+        };
+
+        std::cout << "\n--- Catalog<std::pmr::string> load and scan, " << n << " items ---" << std::endl;
+
+        Tests::CountingResource counting;
+        std::pmr::memory_resource *const previous = std::pmr::set_default_resource(&counting);
+        {
+            std::vector<std::pmr::string> input = feed;
+            Catalog catalog;
+            size_t allocations = counting.allocations;
+            auto start = Clock::now();
+            for (auto const &item : input) {
+                catalog.add_item(item);
+            }
+            report("load, add_item(const&):      ", counting.allocations - allocations, ElapsedMs(start));
+
+            input = feed;
+            Catalog moved;
+            allocations = counting.allocations;
+            start = Clock::now();
+            moved.reserve(input.size());
+            for (auto &item : input) {
+                moved.add_item(std::move(item));
+            }
+            report("load, reserve + add_item(&&): ", counting.allocations - allocations, ElapsedMs(start));
+
+            size_t length = 0;
+            allocations = counting.allocations;
+            start = Clock::now();
+            for (size_t i = 0; i < catalog.size(); ++i) {
+                length += catalog.getItemAt(i).size();
+            }
+            report("scan, getItemAt:              ", counting.allocations - allocations, ElapsedMs(start));
+
+            allocations = counting.allocations;
+            start = Clock::now();
+            for (auto const &item : catalog) {
+                length += item.size();
+            }
+            report("scan, range-for:              ", counting.allocations - allocations, ElapsedMs(start));
+            std::cout << "(total length " << length << ")" << std::endl;
+        }
+        std::pmr::set_default_resource(previous);
+    }
+
+    // Heap bytes currently in use, as reported by glibc.
+    size_t HeapInUse() {
+        return mallinfo2().uordblks;
+    }
+
+    // Millions of item names with heavy duplication: the plain
+    // Catalog<std::string> against an InternedCatalog, for memory and for a
+    // scan that counts one name.
+    void BenchInternedCatalog() {
+        constexpr size_t n = 5'000'000;
+        constexpr size_t distinct = 20'000;
+        std::vector<std::string> names(distinct);
+        for (size_t i = 0; i < distinct; ++i) {
+            names[i] = "Warehouse item name #" + std::to_string(i) + " (standard)";
+        }
+        std::string const needle = names[distinct / 2];
+
+        std::cout << "\n--- Catalog<std::string> vs InternedCatalog, " << n << " items, " << distinct << " distinct ---" << std::endl;
+
+        {
+            size_t const heap_before = HeapInUse();
+            InventorySystem::Catalog catalog;
+            catalog.reserve(n);
+            auto start = Clock::now();
+            for (size_t i = 0; i < n; ++i) {
+                catalog.add_item(names[(i * 7919) % distinct]);
+            }
+            double const load_ms = ElapsedMs(start);
+            size_t const bytes = HeapInUse() - heap_before;
+
+            start = Clock::now();
+            size_t const matches = std::count(catalog.begin(), catalog.end(), needle);
+            double const scan_ms = ElapsedMs(start);
+            std::cout << "Catalog<std::string>: " << bytes / 1e6 << " MB, load " << load_ms << " ms, count scan "
+                      << scan_ms << " ms (" << matches << " matches)" << std::endl;
+        }
+
+        {
+            size_t const heap_before = HeapInUse();
+            InventorySystem::InternedCatalog<> catalog;
+            catalog.reserve(n);
+            auto start = Clock::now();
+            for (size_t i = 0; i < n; ++i) {
+                catalog.add_item(names[(i * 7919) % distinct]);
+            }
+            double const load_ms = ElapsedMs(start);
+            size_t const bytes = HeapInUse() - heap_before;
+
+            start = Clock::now();
+            size_t const matches = catalog.count(needle);
+            double const scan_ms = ElapsedMs(start);
+            std::cout << "InternedCatalog:      " << bytes / 1e6 << " MB, load " << load_ms << " ms, count scan "
+                      << scan_ms << " ms (" << matches << " matches)" << std::endl;
+        }
+    }
+
+    // Several threads append to one catalog: the mutex-free ConcurrentCatalog
+    // against a Catalog behind a mutex.
+    void BenchConcurrentCatalog() {
+        constexpr size_t n = 8'000'000;
+
+        auto run = [](size_t threads, auto &&insert) {
+            std::vector<std::thread> workers;
+            auto const start = Clock::now();
+            for (size_t t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] {
+                    for (size_t i = t; i < n; i += threads) {
+                        insert(static_cast<int64_t>(i));
+                    }
+                });
+            }
+            for (auto &worker : workers) {
+                worker.join();
+            }
+            return n / ElapsedMs(start) / 1e3;
+        };
+
+        std::cout << "\n--- Concurrent insert, million items/s (" << std::thread::hardware_concurrency() << " hardware threads) ---" << std::endl;
+        for (size_t threads = 1; threads <= 32; threads *= 2) {
+            InventorySystem::ConcurrentCatalog<int64_t> lock_free;
+            double const lock_free_rate = run(threads, [&](int64_t item) { lock_free.add_item(item); });
+
+            InventorySystem::Catalog<int64_t> locked;
+            std::mutex mutex;
+            double const locked_rate = run(threads, [&](int64_t item) {
+                std::lock_guard lock(mutex);
+                locked.add_item(item);
+            });
+
+            std::cout << threads << " threads: ConcurrentCatalog " << lock_free_rate << ", mutex + Catalog " << locked_rate << std::endl;
+        }
+    }
+
+    // Lookup latency of Catalog::find with a SwissIndex against the
+    // unindexed linear scan and a std::unordered_map from item to position.
+    // Half of the probes hit and half miss.
+    void BenchCatalogIndex() {
+        constexpr size_t probes = 1'000'000;
+        std::cout << "\n--- Catalog<uint64_t>::find, ns/lookup ---" << std::endl;
+
+        for (size_t n : {size_t{1'000}, size_t{1'000'000}, size_t{50'000'000}}) {
+            std::vector<uint64_t> keys(probes);
+            uint64_t state = 42;
+            for (auto &key : keys) {
+                state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                key = (state >> 11) % (2 * n);
+            }
+            auto time_lookups = [&](size_t count, auto &&lookup) {
+                size_t found = 0;
+                auto const start = Clock::now();
+                for (size_t i = 0; i < count; ++i) {
+                    found += lookup(keys[i]).has_value();
+                }
+                double const ns = ElapsedMs(start) * 1e6 / count;
+                return std::pair{ns, found};
+            };
+
+            std::cout << n << " items:";
+            {
+                InventorySystem::Catalog<uint64_t, std::vector, InventorySystem::SwissIndex<uint64_t>> indexed;
+                indexed.reserve(n);
+                auto const start = Clock::now();
+                for (size_t i = 0; i < n; ++i) {
+                    indexed.add_item(2 * i);
+                }
+                double const build_ms = ElapsedMs(start);
+                auto const [ns, found] = time_lookups(probes, [&](uint64_t key) { return indexed.find(key); });
+                std::cout << " SwissIndex " << ns << " (build " << build_ms << " ms, " << found << " hits)";
+            }
+            // A scan costs O(n) per lookup, so only time it where it finishes.
+            if (n <= 1'000'000) {
+                InventorySystem::Catalog<uint64_t> scanned;
+                for (size_t i = 0; i < n; ++i) {
+                    scanned.add_item(2 * i);
+                }
+                auto const [ns, found] = time_lookups(n <= 1'000 ? probes : 200, [&](uint64_t key) { return scanned.find(key); });
+                std::cout << ", linear scan " << ns << " (" << found << " hits)";
+            }
+            // A node per item puts a 50M-entry map beyond this machine's memory.
+            if (n <= 1'000'000) {
+                std::unordered_map<uint64_t, size_t> map;
+                map.reserve(n);
+                for (size_t i = 0; i < n; ++i) {
+                    map.emplace(2 * i, i);
+                }
+                auto const [ns, found] = time_lookups(probes, [&](uint64_t key) {
+                    auto const it = map.find(key);
+                    return it == map.end() ? std::optional<size_t>{} : std::optional<size_t>{it->second};
+                });
+                std::cout << ", unordered_map " << ns << " (" << found << " hits)";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    // Location queries over WarehouseInventory records stored as a vector of
+    // objects against the columnar InventoryTable.
+    void BenchInventoryTable() {
+        constexpr size_t n = 20'000'000;
+        constexpr size_t warehouses = 64;
+        std::vector<std::string> names(warehouses);
+        for (size_t i = 0; i < warehouses; ++i) {
+            names[i] = "Regional warehouse " + std::to_string(i);
+        }
+        std::string const target = names[17];
+
+        std::vector<InventorySystem::WarehouseInventory<int64_t>> objects;
+        objects.reserve(n);
+        InventorySystem::InventoryTable<int64_t> table;
+        table.reserve(n);
+        uint64_t state = 7;
+        for (size_t i = 0; i < n; ++i) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            auto const &location = names[(state >> 33) % warehouses];
+            objects.emplace_back(static_cast<int64_t>(i), location);
+            table.add_record(static_cast<int64_t>(i), location);
+        }
+
+        std::cout << "\n--- WarehouseInventory location queries, " << n << " records, " << warehouses << " locations, ms ---" << std::endl;
+
+        auto start = Clock::now();
+        size_t const object_count = std::count_if(objects.begin(), objects.end(), [&](auto const &record) { return record.location_ == target; });
+        double const object_count_ms = ElapsedMs(start);
+        start = Clock::now();
+        size_t const table_count = table.count_at(target);
+        double const table_count_ms = ElapsedMs(start);
+
+        start = Clock::now();
+        std::vector<uint32_t> object_rows;
+        for (size_t i = 0; i < objects.size(); ++i) {
+            if (objects[i].location_ == target) {
+                object_rows.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        double const object_select_ms = ElapsedMs(start);
+        start = Clock::now();
+        auto const table_rows = table.select_at(target);
+        double const table_select_ms = ElapsedMs(start);
+
+        start = Clock::now();
+        std::unordered_map<std::string, size_t> object_groups;
+        for (auto const &record : objects) {
+            ++object_groups[record.location_];
+        }
+        double const object_group_ms = ElapsedMs(start);
+        start = Clock::now();
+        auto const table_groups = table.group_counts();
+        double const table_group_ms = ElapsedMs(start);
+
+        if (object_count != table_count || object_rows != table_rows || object_groups[target] != table_groups[*table.location_code(target)]) {
+            throw std::runtime_error("Inventory table benchmark results disagree");
+        }
+
+        std::cout << "count at location:  objects " << object_count_ms << ", table " << table_count_ms << " (" << table_count << " records)" << std::endl;
+        std::cout << "select row IDs:     objects " << object_select_ms << ", table " << table_select_ms << std::endl;
+        std::cout << "group counts:       objects " << object_group_ms << ", table " << table_group_ms << std::endl;
+    }
+
+    // Maintaining a location index under inserts, and the report queries it
+    // answers (a range of warehouses, a location prefix), for the B+-tree
+    // against std::multimap.
+    void BenchLocationIndex() {
+        constexpr size_t n = 5'000'000;
+        std::vector<InventorySystem::WarehouseInventory<int64_t>> records;
+        records.reserve(n);
+        uint64_t state = 11;
+        for (size_t i = 0; i < n; ++i) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            size_t const site = (state >> 33) % 20'000;
+            std::string location = (site % 2 ? "Dock-" : "Warehouse ") + std::to_string(site);
+            records.emplace_back(static_cast<int64_t>(i), std::move(location));
+        }
+
+        std::cout << "\n--- Location index, " << n << " records, ms ---" << std::endl;
+
+        auto queries = [&](auto &&between, auto &&with_prefix) {
+            int64_t checksum = 0;
+            size_t visited = 0;
+            auto const start = Clock::now();
+            for (int repeat = 0; repeat < 10; ++repeat) {
+                for (auto const *record : between("Warehouse 1", "Warehouse 16")) {
+                    checksum += record->item_name_;
+                    ++visited;
+                }
+                for (auto const *record : with_prefix("Dock-7")) {
+                    checksum += record->item_name_;
+                    ++visited;
+                }
+            }
+            return std::tuple{ElapsedMs(start) / 10, visited / 10, checksum};
+        };
+
+        {
+            InventorySystem::LocationIndex<int64_t> index;
+            auto const start = Clock::now();
+            for (auto const &record : records) {
+                index.add(record);
+            }
+            double const insert_ms = ElapsedMs(start);
+            auto const [scan_ms, visited, checksum] = queries([&](char const *a, char const *b) { return index.between(a, b); },
+                                                              [&](char const *p) { return index.with_prefix(p); });
+            std::cout << "B+-tree:        insert " << insert_ms << ", range + prefix scan " << scan_ms << " (" << visited
+                      << " records, checksum " << checksum << ")" << std::endl;
+        }
+
+        {
+            using Map = std::multimap<std::string, InventorySystem::WarehouseInventory<int64_t> const *>;
+            Map index;
+            auto const start = Clock::now();
+            for (auto const &record : records) {
+                index.emplace(record.location_, &record);
+            }
+            double const insert_ms = ElapsedMs(start);
+            auto values = [](Map::const_iterator first, Map::const_iterator last) {
+                return std::ranges::subrange(first, last) | std::views::values;
+            };
+            auto const [scan_ms, visited, checksum] = queries(
+                [&](char const *a, char const *b) { return values(index.lower_bound(a), index.lower_bound(b)); },
+                [&](char const *p) { return values(index.lower_bound(p), index.lower_bound(std::string(p).substr(0, 5) + char(p[5] + 1))); });
+            std::cout << "std::multimap:  insert " << insert_ms << ", range + prefix scan " << scan_ms << " (" << visited
+                      << " records, checksum " << checksum << ")" << std::endl;
+        }
+    }
+
+    // Startup cost: replaying a text feed through add_item /
+    // CreateWarehouseItem against opening a binary snapshot view.
+    void BenchSnapshots() {
+        constexpr size_t n = 5'000'000;
+        auto const directory = std::filesystem::temp_directory_path();
+        std::string const feed_path = (directory / "n217_bench_feed.txt").string();
+        std::string const catalog_path = (directory / "n217_bench_catalog.snap").string();
+        std::string const inventory_path = (directory / "n217_bench_inventory.snap").string();
+
+        {
+            std::ofstream feed(feed_path);
+            for (size_t i = 0; i < n; ++i) {
+                feed << "Warehouse item number " << i << '\t' << "Regional warehouse " << i % 64 << '\n';
+            }
+        }
+
+        std::cout << "\n--- Startup from a text feed vs a binary snapshot, " << n << " records, ms ---" << std::endl;
+
+        InventorySystem::Catalog catalog;
+        std::vector<InventorySystem::WarehouseInventory<>> records;
+        auto start = Clock::now();
+        {
+            std::ifstream feed(feed_path);
+            std::string line;
+            catalog.reserve(n);
+            records.reserve(n);
+            while (std::getline(feed, line)) {
+                size_t const tab = line.find('\t');
+                std::string item = line.substr(0, tab);
+                catalog.add_item(item);
+                records.push_back(InventorySystem::CreateWarehouseItem(item, line.substr(tab + 1)));
+            }
+        }
+        double const replay_ms = ElapsedMs(start);
+
+        start = Clock::now();
+        InventorySystem::SaveCatalogSnapshot(catalog_path, catalog);
+        InventorySystem::SaveInventorySnapshot(inventory_path, records);
+        double const save_ms = ElapsedMs(start);
+
+        start = Clock::now();
+        InventorySystem::CatalogView catalog_view(catalog_path);
+        InventorySystem::InventoryView inventory_view(inventory_path);
+        double const open_ms = ElapsedMs(start);
+
+        start = Clock::now();
+        size_t length = 0;
+        for (size_t i = 0; i < inventory_view.size(); ++i) {
+            length += catalog_view[i].size() + inventory_view.getLocation(i).size();
+        }
+        double const scan_ms = ElapsedMs(start);
+
+        std::cout << "replay text feed: " << replay_ms << std::endl;
+        std::cout << "save snapshots:   " << save_ms << " (" << (std::filesystem::file_size(catalog_path) + std::filesystem::file_size(inventory_path)) / 1e6 << " MB)" << std::endl;
+        std::cout << "open snapshots:   " << open_ms << std::endl;
+        std::cout << "first full scan:  " << scan_ms << " (" << length << " bytes)" << std::endl;
+
+        std::filesystem::remove(feed_path);
+        std::filesystem::remove(catalog_path);
+        std::filesystem::remove(inventory_path);
+    }
+
+    // Readers doing point lookups while one writer keeps adding items: the
+    // RCU catalog against a Catalog behind a std::shared_mutex.
+    void BenchRcuCatalog() {
+        constexpr auto duration = std::chrono::milliseconds(300);
+
+        // Runs readers and one writer for the duration; each reader thread
+        // gets its lookup function from make_read. Returns million reads/s
+        // and million writes/s.
+        auto run = [&](size_t readers, auto &&make_read, auto &&write) {
+            std::atomic<bool> stop{false};
+            std::atomic<size_t> reads{0};
+            size_t writes = 0;
+            std::vector<std::thread> threads;
+            for (size_t r = 0; r < readers; ++r) {
+                threads.emplace_back([&, r] {
+                    auto read = make_read();
+                    uint64_t state = r + 1;
+                    size_t local = 0;
+                    int64_t checksum = 0;
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                        checksum += read(state >> 20);
+                        ++local;
+                    }
+                    reads += local + (checksum == 42);
+                });
+            }
+            std::thread writer([&] {
+                while (!stop.load(std::memory_order_relaxed)) {
+                    write(static_cast<int64_t>(writes++));
+                }
+            });
+            std::this_thread::sleep_for(duration);
+            stop = true;
+            writer.join();
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            double const seconds = std::chrono::duration<double>(duration).count();
+            return std::pair{reads / seconds / 1e6, writes / seconds / 1e6};
+        };
+
+        std::cout << "\n--- Reads with a concurrent writer, million ops/s (" << std::thread::hardware_concurrency() << " hardware threads) ---" << std::endl;
+        for (size_t readers = 1; readers <= 16; readers *= 2) {
+            InventorySystem::RcuCatalog<int64_t> rcu;
+            std::vector<int64_t> seed(100'000);
+            std::iota(seed.begin(), seed.end(), 0);
+            rcu.add_items(seed);
+            auto const [rcu_reads, rcu_writes] = run(
+                readers,
+                [&] {
+                    return [reader = rcu.reader()](uint64_t random) {
+                        auto const snapshot = reader.snapshot();
+                        return snapshot[random % snapshot.size()];
+                    };
+                },
+                [&](int64_t item) { rcu.add_item(item); });
+
+            InventorySystem::Catalog<int64_t> locked;
+            locked.item_list_ = seed;
+            std::shared_mutex mutex;
+            auto const [locked_reads, locked_writes] = run(
+                readers,
+                [&] {
+                    return [&](uint64_t random) {
+                        std::shared_lock lock(mutex);
+                        return locked[random % locked.size()];
+                    };
+                },
+                [&](int64_t item) {
+                    std::unique_lock lock(mutex);
+                    locked.add_item(item);
+                });
+
+            std::cout << readers << " readers: RcuCatalog reads " << rcu_reads << ", writes " << rcu_writes << "; shared_mutex + Catalog reads "
+                      << locked_reads << ", writes " << locked_writes << std::endl;
+        }
+    }
+
+    // Writing inventory reports for every record: ShowInventoryDetails on
+    // an ostream against the buffered ReportWriter, both to /dev/null so
+    // only the formatting and system call costs are measured.
+    void BenchReportWriter() {
+        constexpr size_t n = 10'000'000;
+        std::vector<InventorySystem::WarehouseInventory<int64_t>> records;
+        records.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            records.emplace_back(static_cast<int64_t>(i) * 7919, "Warehouse " + std::to_string(i % 64));
+        }
+        using Record = InventorySystem::WarehouseInventory<int64_t>;
+
+        std::cout << "\n--- Inventory report, " << n << " records, ms ---" << std::endl;
+        {
+            std::ofstream out("/dev/null");
+            auto const start = Clock::now();
+            for (auto const &record : records) {
+                Record::ShowInventoryDetails(out, record.item_name_, record.location_);
+            }
+            out.flush();
+            std::cout << "ostream, ShowInventoryDetails: " << ElapsedMs(start) << std::endl;
+        }
+
+        int const fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+        {
+            auto const start = Clock::now();
+            InventorySystem::ReportWriter writer(fd);
+            for (auto const &record : records) {
+                writer.write_details<Record>(record.item_name_, record.location_);
+            }
+            writer.flush();
+            std::cout << "ReportWriter, per record:      " << ElapsedMs(start) << std::endl;
+        }
+        {
+            auto const start = Clock::now();
+            InventorySystem::ReportWriter writer(fd);
+            writer.write_records(records);
+            writer.flush();
+            std::cout << "ReportWriter, whole batch:     " << ElapsedMs(start) << std::endl;
+        }
+        ::close(fd);
+    }
+
+    // Query algorithms over a Catalog<int64_t> with pools of 1 to 16
+    // threads, against a hand-written getItemAt loop.
+    void BenchQueries() {
+        constexpr size_t n = 20'000'000;
+        InventorySystem::Catalog<int64_t> catalog;
+        catalog.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            catalog.add_item(static_cast<int64_t>(i * 2654435761u % 1'000'003));
+        }
+        auto const selective = [](int64_t x) { return x % 7 == 0; };
+        auto const weight = [](int64_t x) { return 3 * x + 1; };
+
+        std::cout << "\n--- Catalog queries, " << n << " items, ms (" << std::thread::hardware_concurrency() << " hardware threads) ---" << std::endl;
+        {
+            auto const start = Clock::now();
+            size_t count = 0;
+            int64_t sum = 0;
+            for (size_t i = 0; i < catalog.size(); ++i) {
+                count += selective(catalog.getItemAt(i));
+                sum += weight(catalog.getItemAt(i));
+            }
+            std::cout << "getItemAt loop, count + sum: " << ElapsedMs(start) << " (" << count << ", " << sum << ")" << std::endl;
+        }
+        for (size_t threads = 1; threads <= 16; threads *= 2) {
+            InventorySystem::QueryPool pool(threads);
+            auto start = Clock::now();
+            size_t const count = InventorySystem::Query::count_if(catalog, selective, pool);
+            double const count_ms = ElapsedMs(start);
+            start = Clock::now();
+            int64_t const sum = InventorySystem::Query::transform_reduce(catalog, int64_t{0}, std::plus<>(), weight, pool);
+            double const reduce_ms = ElapsedMs(start);
+            start = Clock::now();
+            size_t const matches = InventorySystem::Query::filter(catalog, selective, pool).size();
+            double const filter_ms = ElapsedMs(start);
+            start = Clock::now();
+            size_t const kept = InventorySystem::Query::partition(catalog, selective, pool).first.size();
+            double const partition_ms = ElapsedMs(start);
+            if (count != matches || count != kept) {
+                throw std::runtime_error("Catalog query benchmark results disagree");
+            }
+            std::cout << threads << " threads: count_if " << count_ms << ", transform_reduce " << reduce_ms << ", filter " << filter_ms
+                      << ", partition " << partition_ms << " (" << count << ", " << sum << ")" << std::endl;
+        }
+    }
+
+    // Loading and freeing a batch of records whose strings need the heap:
+    // std::string members from malloc against std::pmr strings from a
+    // monotonic arena that is released in one call.
+    void BenchPmrAllocation() {
+        constexpr size_t n = 1'000'000;
+        std::vector<std::string> items(n);
+        std::vector<std::string> locations(64);
+        for (size_t i = 0; i < n; ++i) {
+            items[i] = "Warehouse item with a long name #" + std::to_string(i);
+        }
+        for (size_t i = 0; i < locations.size(); ++i) {
+            locations[i] = "Regional distribution warehouse " + std::to_string(i);
+        }
+
+        auto report = [](char const *label, double load_ms, double teardown_ms, size_t allocations) {
+            std::cout << label << "load " << load_ms << ", teardown " << teardown_ms << ", " << allocations << " heap allocations" << std::endl;
+        };
+
+        std::cout << "\n--- Batch of " << n << " WarehouseInventory records, ms ---" << std::endl;
+        {
+            // Every string straight from new/delete, counted on the way.
+            auto start = Clock::now();
+            Tests::CountingResource heap;
+            auto *batch = new std::pmr::vector<InventorySystem::PmrWarehouseInventory>(&heap);
+            batch->reserve(n);
+            for (size_t i = 0; i < n; ++i) {
+                batch->emplace_back(items[i], locations[i % locations.size()]);
+            }
+            double const load_ms = ElapsedMs(start);
+            start = Clock::now();
+            delete batch;
+            report("new/delete:      ", load_ms, ElapsedMs(start), heap.allocations);
+        }
+        {
+            auto start = Clock::now();
+            Tests::CountingResource upstream;
+            auto *arena = new std::pmr::monotonic_buffer_resource(size_t{1} << 20, &upstream);
+            auto *batch = new std::pmr::vector<InventorySystem::PmrWarehouseInventory>(arena);
+            batch->reserve(n);
+            for (size_t i = 0; i < n; ++i) {
+                batch->emplace_back(items[i], locations[i % locations.size()]);
+            }
+            double const load_ms = ElapsedMs(start);
+            start = Clock::now();
+            delete batch;
+            delete arena;
+            report("monotonic arena: ", load_ms, ElapsedMs(start), upstream.allocations);
+        }
+    }
+
+    void RunBenchmarks() {
+        BenchPmrAllocation();
+        BenchQueries();
+        BenchReportWriter();
+        BenchRcuCatalog();
+        BenchSnapshots();
+        BenchLocationIndex();
+        BenchInventoryTable();
+        BenchCatalogIndex();
+        BenchConcurrentCatalog();
+        BenchInternedCatalog();
+        BenchCatalogAccess();
+        BenchChunkedContainer();
+    }
+} // namespace Benchmarks
+
+int main(int argc, char *argv[]) {
+    Tests::RunTests();
+
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        Benchmarks::RunBenchmarks();
+    }
     return 0;
 }
\ No newline at end of file
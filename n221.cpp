@@ -1,186 +1,1000 @@
-// #include <iostream>
-// #include <string>
-// #include <concepts>
-// #include <type_traits>
-// // THIS CODE IS WRONG 
-// namespace n221_exercise
-// {
-
-// // 1950s Business Context: A Department Store Ordering System
-
-// // Forward Declarations (To avoid circular dependencies if needed later)
-// template <typename ItemType, typename ProcessingPolicy , typename Currency, typename InvoiceFormat >
-// class OrderForm;
-
-// // --- Supporting Types and Concepts ---
-
-// // Concept for Item Types (could have properties like name, base price)
-// template <typename T>
-// concept InventoryItemConcept = requires(T a) {
-//     { a.getName() } -> std::same_as<std::string>;
-// };
-
-// // Basic Inventory Item Structure
-// template <const char* ItemName>
-// struct InventoryItem
-// {
-    
-//     static constexpr const char*  name = ItemName;
-//     std::string getName() const { return std::string(name); }
-// };
-
-// // Processing Policies
-// struct DefaultProcessingPolicy { static constexpr double markup_percentage = 0.10; };
-// struct ExpeditedProcessingPolicy { static constexpr double markup_percentage = 0.25; };
-// struct BulkOrderProcessing { static constexpr double discount_percentage = 0.05; };
-
-// // Currencies
-// struct USDollar { static constexpr std::string_view symbol = "$"; };
-// struct CanadianDollar { static constexpr std::string_view symbol = "CAD"; };
-
-// // Invoice Formats
-// struct CarbonCopyInvoice { static constexpr std::string_view format_type = "Carbon Copy"; };
-// struct TypedInvoice { static constexpr std::string_view format_type = "Typed"; };
-
-// // --- Main OrderForm Template ---
-
-// template <typename ItemType, typename ProcessingPolicy, typename Currency, typename InvoiceFormat>
-// class OrderForm
-// {
-// public:
-//     // Static Assert to ensure ItemType meets the concept
-//     static_assert(InventoryItemConcept<ItemType>, "ItemType must satisfy the InventoryItemConcept.");
-
-//     using item_type = ItemType;
-//     using processing_policy = ProcessingPolicy;
-//     using currency_type = Currency;
-//     using invoice_format = InvoiceFormat;
-
-//     OrderForm(int quantity) : quantity_(quantity) {}
-
-//     std::string getItemName() const { return item_type::name; }
-//     int getQuantity() const { return quantity_; }
-//     std::string getCurrencySymbol() const { return currency_type::symbol; }
-//     std::string getInvoiceFormatType() const { return invoice_format::format_type; }
-
-//     // TO-DO: This is the hardest part - Calculate the total price based on quantity and policies.
-//     double calculateTotalPrice() const
-//     {
-//         // Access policy specifics using processing_policy::markup_percentage etc.
-//         // Consider bulk order discounts if applicable.
-//         // Make sure to think about potential interactions between different policies.
-//         // You might need SFINAE or if constexpr for different policy types.
-//         // The core logic needs careful consideration of all factors.
-//         // Think about edge cases and different combinations.
-//         // This part should be challenging but achievable with the template parameters available.
-
-//         // Placeholder - REPLACE THIS WITH YOUR LOGIC
-//         return -1.0; // Indicate not yet implemented
-//     }
-
-//     // Boilerplate function to print order details
-//     void printOrder() const
-//     {
-//         std::cout << "--- Order Details ---\n";
-//         std::cout << "Item: " << getItemName() << "\n";
-//         std::cout << "Quantity: " << getQuantity() << "\n";
-//         std::cout << "Processing: ";
-//         if constexpr (std::is_same_v<ProcessingPolicy, DefaultProcessingPolicy>) {
-//             std::cout << "Standard\n";
-//         } else if constexpr (std::is_same_v<ProcessingPolicy, ExpeditedProcessingPolicy>) {
-//             std::cout << "Expedited\n";
-//         } else if constexpr (std::is_same_v<ProcessingPolicy, BulkOrderProcessing>) {
-//             std::cout << "Bulk\n";
-//         } else {
-//             std::cout << "Custom\n";
-//         }
-//         std::cout << "Currency: " << getCurrencySymbol() << "\n";
-//         std::cout << "Invoice Format: " << getInvoiceFormatType() << "\n";
-//         double total = calculateTotalPrice();
-//         std::cout << "Total Price: ";
-//         if (total >= 0) {
-//             std::cout << total << getCurrencySymbol() << "\n";
-//         } else {
-//             std::cout << "[Calculation Pending]\n";
-//         }
-//         std::cout << "--------------------\n";
-//     }
-
-// private:
-//     int quantity_;
-// };
-
-// } // namespace n221_exercise
-
-// namespace n221_exercise_test
-// {
-//     using namespace n221_exercise;
-
-//     void run_tests()
-//     {
-//         // Test Case 1: Simple order with default settings
-//         OrderForm<InventoryItem<"Hat">, DefaultProcessingPolicy, USDollar, CarbonCopyInvoice> order1(2);
-//         static_assert(std::is_same_v<decltype(order1)::item_type, InventoryItem<"Hat">>);
-//         static_assert(std::is_same_v<decltype(order1)::processing_policy, DefaultProcessingPolicy>);
-//         static_assert(std::is_same_v<decltype(order1)::currency_type, USDollar>);
-//         static_assert(std::is_same_v<decltype(order1)::invoice_format, CarbonCopyInvoice>);
-//         // The core logic is missing, so we can't assert the price yet.
-//         std::cout << "Test Case 1:\n";
-//         order1.printOrder();
-//         std::cout << "\n";
-
-//         // Test Case 2: Order with expedited processing
-//         OrderForm<InventoryItem<"Dress">, ExpeditedProcessingPolicy, USDollar, CarbonCopyInvoice> order2(1);
-//         static_assert(std::is_same_v<decltype(order2)::processing_policy, ExpeditedProcessingPolicy>);
-//         std::cout << "Test Case 2:\n";
-//         order2.printOrder();
-//         std::cout << "\n";
-
-//         // Test Case 3: Order with Canadian dollars and typed invoice
-//         OrderForm<InventoryItem<"Suit">, DefaultProcessingPolicy, CanadianDollar, TypedInvoice> order3(3);
-//         static_assert(std::is_same_v<decltype(order3)::currency_type, CanadianDollar>);
-//         static_assert(std::is_same_v<decltype(order3)::invoice_format, TypedInvoice>);
-//         std::cout << "Test Case 3:\n";
-//         order3.printOrder();
-//         std::cout << "\n";
-
-//         // Test Case 4: Bulk order with discount
-//         OrderForm<InventoryItem<"Gloves">, BulkOrderProcessing, USDollar, CarbonCopyInvoice> order4(10);
-//         static_assert(std::is_same_v<decltype(order4)::processing_policy, BulkOrderProcessing>);
-//         std::cout << "Test Case 4:\n";
-//         order4.printOrder();
-//         std::cout << "\n";
-
-//         // Test Case 5: Using default template arguments explicitly
-//         OrderForm<InventoryItem<"Shirt">> order5(5);
-//         static_assert(std::is_same_v<decltype(order5)::processing_policy, DefaultProcessingPolicy>);
-//         static_assert(std::is_same_v<decltype(order5)::currency_type, USDollar>);
-//         static_assert(std::is_same_v<decltype(order5)::invoice_format, CarbonCopyInvoice>);
-//         std::cout << "Test Case 5:\n";
-//         order5.printOrder();
-//         std::cout << "\n";
-
-//          // Static Assert demonstrating the concept requirement
-//         struct InvalidItem { int getName() { return 1; } }; // Doesn't meet the concept
-//         // static_assert(!InventoryItemConcept<InvalidItem>, "Intentional fail if concept check is wrong");
-//         // The following line should cause a compilation error due to the static_assert in OrderForm
-//         // OrderForm<InvalidItem> invalid_order(1); // Uncommenting this will cause a compile error
-
-//         std::cout << "All basic tests completed (core logic tests pending implementation).\n";
-//     }
-// } // namespace n221_exercise_test
-
-// int main()
-// {
-//     n221_exercise_test::run_tests();
-//     return 0;
-// }
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include <fcntl.h>
+#include <unistd.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-#include <iostream>
+namespace n221_exercise
+{
+
+// 1950s Business Context: A Department Store Ordering System
+
+// A string usable as a template argument, so item names can be spelled
+// InventoryItem<"Hat">.
+template <std::size_t N>
+struct string_literal
+{
+    constexpr string_literal(const char (&str)[N])
+    {
+        std::copy_n(str, N, value);
+    }
+
+    constexpr std::string_view view() const { return {value, N - 1}; }
+
+    char value[N];
+};
+
+// --- Supporting Types and Concepts ---
+
+// Concept for Item Types (could have properties like name, base price)
+template <typename T>
+concept InventoryItemConcept = requires(T a) {
+    { a.getName() } -> std::same_as<std::string>;
+};
+
+// Basic Inventory Item Structure
+template <string_literal ItemName>
+struct InventoryItem
+{
+    static constexpr std::string_view name = ItemName.view();
+    std::string getName() const { return std::string(name); }
+};
+
+// Processing Policies
+struct DefaultProcessingPolicy { static constexpr double markup_percentage = 0.10; };
+struct ExpeditedProcessingPolicy { static constexpr double markup_percentage = 0.25; };
+struct BulkOrderProcessing { static constexpr double discount_percentage = 0.05; };
+
+// Currencies. Prices are quoted in US dollars; exchange_rate converts them.
+struct USDollar
+{
+    static constexpr std::string_view symbol = "$";
+    static constexpr double exchange_rate = 1.0;
+};
+struct CanadianDollar
+{
+    static constexpr std::string_view symbol = "CAD";
+    static constexpr double exchange_rate = 0.97;
+};
+
+// Invoice Formats
+struct CarbonCopyInvoice { static constexpr std::string_view format_type = "Carbon Copy"; };
+struct TypedInvoice { static constexpr std::string_view format_type = "Typed"; };
+
+// --- Pricing ---
+
+// A policy may define a markup, a discount, both or neither; a missing one
+// counts as zero, and a currency without an exchange rate as 1.
+template <typename ProcessingPolicy>
+constexpr double markup_of()
+{
+    if constexpr (requires { ProcessingPolicy::markup_percentage; }) {
+        return ProcessingPolicy::markup_percentage;
+    } else {
+        return 0.0;
+    }
+}
+
+template <typename ProcessingPolicy>
+constexpr double discount_of()
+{
+    if constexpr (requires { ProcessingPolicy::discount_percentage; }) {
+        return ProcessingPolicy::discount_percentage;
+    } else {
+        return 0.0;
+    }
+}
+
+template <typename Currency>
+constexpr double exchange_rate_of()
+{
+    if constexpr (requires { Currency::exchange_rate; }) {
+        return Currency::exchange_rate;
+    } else {
+        return 1.0;
+    }
+}
+
+// The name printed for a processing policy.
+template <typename ProcessingPolicy>
+constexpr std::string_view processing_name_of()
+{
+    if constexpr (std::is_same_v<ProcessingPolicy, DefaultProcessingPolicy>) {
+        return "Standard";
+    } else if constexpr (std::is_same_v<ProcessingPolicy, ExpeditedProcessingPolicy>) {
+        return "Expedited";
+    } else if constexpr (std::is_same_v<ProcessingPolicy, BulkOrderProcessing>) {
+        return "Bulk";
+    } else {
+        return "Custom";
+    }
+}
+
+// Everything a unit price is multiplied by, folded into one constant:
+// markup, then discount on the marked-up price, then conversion.
+template <typename ProcessingPolicy, typename Currency>
+inline constexpr double price_multiplier =
+    (1.0 + markup_of<ProcessingPolicy>()) * (1.0 - discount_of<ProcessingPolicy>()) * exchange_rate_of<Currency>();
+
+// --- Main OrderForm Template ---
+
+template <typename ItemType, typename ProcessingPolicy = DefaultProcessingPolicy, typename Currency = USDollar, typename InvoiceFormat = CarbonCopyInvoice>
+class OrderForm
+{
+public:
+    // Static Assert to ensure ItemType meets the concept
+    static_assert(InventoryItemConcept<ItemType>, "ItemType must satisfy the InventoryItemConcept.");
+
+    using item_type = ItemType;
+    using processing_policy = ProcessingPolicy;
+    using currency_type = Currency;
+    using invoice_format = InvoiceFormat;
+
+    static constexpr double multiplier = price_multiplier<ProcessingPolicy, Currency>;
+
+    // unit_price is in US dollars.
+    OrderForm(int quantity, double unit_price) : quantity_(quantity), unit_price_(unit_price) {}
+
+    std::string getItemName() const { return std::string(item_type::name); }
+    int getQuantity() const { return quantity_; }
+    double getUnitPrice() const { return unit_price_; }
+    std::string getCurrencySymbol() const { return std::string(currency_type::symbol); }
+    std::string getInvoiceFormatType() const { return std::string(invoice_format::format_type); }
+
+    // Total in the order's currency.
+    double calculateTotalPrice() const
+    {
+        return quantity_ * unit_price_ * multiplier;
+    }
+
+    // Boilerplate function to print order details
+    void printOrder() const
+    {
+        std::cout << "--- Order Details ---\n";
+        std::cout << "Item: " << getItemName() << "\n";
+        std::cout << "Quantity: " << getQuantity() << "\n";
+        std::cout << "Processing: " << processing_name_of<ProcessingPolicy>() << "\n";
+        std::cout << "Currency: " << getCurrencySymbol() << "\n";
+        std::cout << "Invoice Format: " << getInvoiceFormatType() << "\n";
+        double total = calculateTotalPrice();
+        std::cout << "Total Price: ";
+        if (total >= 0) {
+            std::cout << total << getCurrencySymbol() << "\n";
+        } else {
+            std::cout << "[Calculation Pending]\n";
+        }
+        std::cout << "--------------------\n";
+    }
+
+private:
+    int quantity_;
+    double unit_price_;
+};
+
+// Prices many orders of one (Item, ProcessingPolicy, Currency) combination
+// held as columns. The policy and currency are a single compile-time
+// constant, so the loop is a convert and two multiplies per order, done two
+// orders per SSE2 instruction. Each total equals what OrderForm computes
+// for the same order.
+template <typename ItemType, typename ProcessingPolicy = DefaultProcessingPolicy, typename Currency = USDollar>
+struct BatchPricer
+{
+    static_assert(InventoryItemConcept<ItemType>, "ItemType must satisfy the InventoryItemConcept.");
+
+    static constexpr double multiplier = price_multiplier<ProcessingPolicy, Currency>;
+
+    // totals[i] = quantities[i] * unit_prices[i] * multiplier
+    static void price(std::span<const int> quantities, std::span<const double> unit_prices, std::span<double> totals)
+    {
+        if (unit_prices.size() != quantities.size() || totals.size() != quantities.size()) {
+            throw std::invalid_argument("BatchPricer: columns differ in length");
+        }
+
+        std::size_t const n = quantities.size();
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        __m128d const factor = _mm_set1_pd(multiplier);
+        for (; i + 4 <= n; i += 4) {
+            __m128i const q = _mm_loadu_si128(reinterpret_cast<__m128i const *>(&quantities[i]));
+            __m128d const low = _mm_mul_pd(_mm_mul_pd(_mm_cvtepi32_pd(q), _mm_loadu_pd(&unit_prices[i])), factor);
+            __m128d const high = _mm_mul_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(q, q)), _mm_loadu_pd(&unit_prices[i + 2])), factor);
+            _mm_storeu_pd(&totals[i], low);
+            _mm_storeu_pd(&totals[i + 2], high);
+        }
+#endif
+        for (; i < n; ++i) {
+            totals[i] = quantities[i] * unit_prices[i] * multiplier;
+        }
+    }
+};
+
+// --- Runtime dispatch through a compile-time price table ---
+
+template <typename... Ts>
+struct type_list
+{
+    static constexpr std::size_t size = sizeof...(Ts);
+};
+
+template <std::size_t I, typename List>
+struct type_at;
+
+template <std::size_t I, typename... Ts>
+struct type_at<I, type_list<Ts...>>
+{
+    using type = std::tuple_element_t<I, std::tuple<Ts...>>;
+};
+
+template <std::size_t I, typename List>
+using type_at_t = typename type_at<I, List>::type;
+
+// The combinations orders can arrive with at runtime. The enum IDs below
+// are positions in these lists.
+using RegisteredItems = type_list<InventoryItem<"Hat">, InventoryItem<"Dress">, InventoryItem<"Suit">, InventoryItem<"Gloves">, InventoryItem<"Shirt">>;
+using RegisteredPolicies = type_list<DefaultProcessingPolicy, ExpeditedProcessingPolicy, BulkOrderProcessing>;
+using RegisteredCurrencies = type_list<USDollar, CanadianDollar>;
+using RegisteredInvoiceFormats = type_list<CarbonCopyInvoice, TypedInvoice>;
+
+enum class ItemId : std::uint8_t { Hat, Dress, Suit, Gloves, Shirt };
+enum class PolicyId : std::uint8_t { Default, Expedited, Bulk };
+enum class CurrencyId : std::uint8_t { USDollar, CanadianDollar };
+enum class InvoiceFormatId : std::uint8_t { CarbonCopy, Typed };
+
+static_assert(RegisteredItems::size == 5 && RegisteredPolicies::size == 3 && RegisteredCurrencies::size == 2 && RegisteredInvoiceFormats::size == 2,
+              "Keep the ID enums in step with the registered type lists.");
+
+// Everything about one Item x Policy x Currency x InvoiceFormat combination
+// that pricing and printing an order needs.
+struct PriceEntry
+{
+    double multiplier;
+    std::string_view item_name;
+    std::string_view processing;
+    std::string_view currency_symbol;
+    std::string_view invoice_format;
+};
+
+namespace detail
+{
+    template <std::size_t Index>
+    constexpr PriceEntry make_price_entry()
+    {
+        constexpr std::size_t formats = RegisteredInvoiceFormats::size;
+        constexpr std::size_t currencies = RegisteredCurrencies::size;
+        constexpr std::size_t policies = RegisteredPolicies::size;
+        using Item = type_at_t<Index / formats / currencies / policies, RegisteredItems>;
+        using Policy = type_at_t<Index / formats / currencies % policies, RegisteredPolicies>;
+        using Currency = type_at_t<Index / formats % currencies, RegisteredCurrencies>;
+        using Format = type_at_t<Index % formats, RegisteredInvoiceFormats>;
+        return {price_multiplier<Policy, Currency>, Item::name, processing_name_of<Policy>(), Currency::symbol, Format::format_type};
+    }
+
+    template <std::size_t... Indices>
+    constexpr auto make_price_table(std::index_sequence<Indices...>)
+    {
+        return std::array<PriceEntry, sizeof...(Indices)>{make_price_entry<Indices>()...};
+    }
+} // namespace detail
+
+// One entry per registered combination, built entirely at compile time.
+inline constexpr auto price_table = detail::make_price_table(
+    std::make_index_sequence<RegisteredItems::size * RegisteredPolicies::size * RegisteredCurrencies::size * RegisteredInvoiceFormats::size>{});
+
+constexpr PriceEntry const &lookup_price_entry(ItemId item, PolicyId policy, CurrencyId currency, InvoiceFormatId format)
+{
+    std::size_t const index = ((static_cast<std::size_t>(item) * RegisteredPolicies::size + static_cast<std::size_t>(policy)) * RegisteredCurrencies::size +
+                               static_cast<std::size_t>(currency)) * RegisteredInvoiceFormats::size + static_cast<std::size_t>(format);
+    return price_table[index];
+}
+
+// An order whose item, policy, currency and invoice format are only known
+// at runtime.
+struct RuntimeOrder
+{
+    ItemId item;
+    PolicyId policy;
+    CurrencyId currency;
+    InvoiceFormatId format;
+    int quantity;
+    double unit_price;
+};
+
+// The same total OrderForm computes for this combination.
+inline double calculate_total_price(RuntimeOrder const &order)
+{
+    return order.quantity * order.unit_price * lookup_price_entry(order.item, order.policy, order.currency, order.format).multiplier;
+}
+
+// --- Concurrent order pipeline ---
+
+// Bounded single-producer single-consumer queue. Head and tail are free
+// running counters on separate cache lines; each side caches the other's
+// counter and rereads it only when the queue looks full or empty.
+template <typename T>
+class spsc_queue
+{
+public:
+    explicit spsc_queue(std::size_t capacity) : slots_(std::bit_ceil(std::max<std::size_t>(capacity, 2))), mask_(slots_.size() - 1) {}
+
+    bool try_push(T value)
+    {
+        std::size_t const tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == slots_.size()) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == slots_.size()) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<T> try_pop()
+    {
+        std::size_t const head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return std::nullopt;
+            }
+        }
+        T value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    // Approximate when called from a third thread.
+    std::size_t size() const { return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire); }
+    std::size_t capacity() const { return slots_.size(); }
+
+private:
+    std::vector<T> slots_;
+    std::size_t mask_;
+    alignas(64) std::atomic<std::size_t> head_{0};
+    std::size_t cached_tail_ = 0;  // consumer's copy of tail_
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    std::size_t cached_head_ = 0;  // producer's copy of head_
+};
+
+// Spins briefly, then yields, so a waiting stage gives its core to the
+// stage it is waiting for.
+inline void pipeline_backoff(unsigned &spins)
+{
+    if (++spins < 64) {
+        return;
+    }
+    std::this_thread::yield();
+}
+
+struct stage_counters
+{
+    std::atomic<std::uint64_t> batches{0};
+    std::atomic<std::uint64_t> orders{0};
+    std::atomic<std::uint64_t> busy_ns{0};  // time spent working (render includes the sink), not waiting
+};
+
+struct queue_counters
+{
+    std::atomic<std::size_t> max_depth{0};
+    std::atomic<std::uint64_t> full_stalls{0};  // pushes that had to wait: backpressure
+};
+
+// Pipeline counters, summed over lanes and runs. They may be read while
+// the pipeline is running.
+struct pipeline_stats
+{
+    stage_counters validate, price, render;
+    queue_counters to_price, to_render;
+    std::atomic<std::uint64_t> rejected{0};
+};
+
+struct pipeline_config
+{
+    std::size_t lanes = std::max(1u, std::thread::hardware_concurrency() / 3);
+    std::size_t batch_size = 1024;
+    std::size_t queue_capacity = 16;  // batches between two stages
+};
+
+// validate -> price -> render, each stage on its own thread, connected by
+// bounded spsc_queues that carry batches of orders. A lane is one such
+// chain of three threads; lanes take every lanes-th batch of the input.
+// Batches come from a fixed pool per lane and return to it after render,
+// so when the sink falls behind the queues fill and validation waits.
+class order_pipeline
+{
+    struct order_batch
+    {
+        std::vector<RuntimeOrder> orders;
+        std::vector<double> totals;
+        std::vector<std::uint8_t> accepted;
+        std::string invoices;
+        std::size_t count = 0;
+    };
+
+    using batch_queue = spsc_queue<order_batch *>;
+
+    static std::uint64_t now_ns()
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Waits for room in queue. Gives up, dropping batch, once another
+    // stage has failed.
+    static void push(batch_queue &queue, order_batch *batch, queue_counters &counters, std::atomic<bool> const &failed)
+    {
+        if (!queue.try_push(batch)) {
+            counters.full_stalls.fetch_add(1, std::memory_order_relaxed);
+            for (unsigned spins = 0; !queue.try_push(batch);) {
+                if (failed.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                pipeline_backoff(spins);
+            }
+        }
+        std::size_t const depth = queue.size();
+        std::size_t seen = counters.max_depth.load(std::memory_order_relaxed);
+        while (depth > seen && !counters.max_depth.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Waits for the next batch; nullptr ends the stream, and is also
+    // returned once another stage has failed.
+    static order_batch *pop(batch_queue &queue, std::atomic<bool> const &failed)
+    {
+        for (unsigned spins = 0;;) {
+            if (failed.load(std::memory_order_relaxed)) {
+                return nullptr;
+            }
+            if (auto batch = queue.try_pop()) {
+                return *batch;
+            }
+            pipeline_backoff(spins);
+        }
+    }
+
+    static void count(stage_counters &counters, std::size_t orders, std::uint64_t start_ns)
+    {
+        counters.batches.fetch_add(1, std::memory_order_relaxed);
+        counters.orders.fetch_add(orders, std::memory_order_relaxed);
+        counters.busy_ns.fetch_add(now_ns() - start_ns, std::memory_order_relaxed);
+    }
+
+public:
+    explicit order_pipeline(pipeline_config config = {}) : config_(config)
+    {
+        if (config_.lanes == 0 || config_.batch_size == 0 || config_.queue_capacity == 0) {
+            throw std::invalid_argument("order_pipeline: lanes, batch size and queue capacity must be positive");
+        }
+    }
+
+    // Largest total whose whole cents render_invoice can hold in a long long.
+    static constexpr double max_total = 9e16;
+
+    static bool is_valid(RuntimeOrder const &order)
+    {
+        return static_cast<std::size_t>(order.item) < RegisteredItems::size && static_cast<std::size_t>(order.policy) < RegisteredPolicies::size &&
+               static_cast<std::size_t>(order.currency) < RegisteredCurrencies::size &&
+               static_cast<std::size_t>(order.format) < RegisteredInvoiceFormats::size && order.quantity > 0 && order.unit_price >= 0.0 &&
+               calculate_total_price(order) <= max_total;
+    }
+
+    // Appends the invoice line for an accepted order.
+    static void render_invoice(std::string &out, RuntimeOrder const &order, double total)
+    {
+        PriceEntry const &entry = lookup_price_entry(order.item, order.policy, order.currency, order.format);
+        char number[32];
+        out.append(entry.invoice_format).append(" invoice: ");
+        out.append(number, std::to_chars(number, number + sizeof number, order.quantity).ptr);
+        out.append(" x ").append(entry.item_name).append(" (").append(entry.processing).append(") = ");
+        // Whole cents as integers: much cheaper than fixed-precision to_chars on a double.
+        if (!(total >= 0.0 && total <= max_total)) {
+            throw std::out_of_range("order_pipeline: invoice total out of range");
+        }
+        long long const cents = std::llround(total * 100.0);
+        out.append(number, std::to_chars(number, number + sizeof number, cents / 100).ptr).push_back('.');
+        out.push_back(static_cast<char>('0' + cents % 100 / 10));
+        out.push_back(static_cast<char>('0' + cents % 10));
+        out.append(entry.currency_symbol).push_back('\n');
+    }
+
+    // Runs every order through the pipeline. sink(lane, text) receives each
+    // batch's invoices, in input order within a lane; it is called from
+    // one thread per lane. Returns once the last batch has been rendered.
+    // If a stage or the sink throws, every stage stops at its next queue
+    // operation and the first exception is rethrown once all threads
+    // have joined.
+    template <typename Sink>
+    void run(std::span<RuntimeOrder const> orders, Sink &&sink)
+    {
+        std::size_t const lanes = config_.lanes;
+        std::size_t const batch_size = config_.batch_size;
+        std::size_t const batches = (orders.size() + batch_size - 1) / batch_size;
+
+        struct lane_state
+        {
+            std::vector<order_batch> pool;
+            batch_queue free, to_price, to_render;
+
+            lane_state(std::size_t pool_size, std::size_t capacity) : pool(pool_size), free(pool_size), to_price(capacity), to_render(capacity) {}
+        };
+        std::vector<std::unique_ptr<lane_state>> state;
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            auto &s = *state.emplace_back(std::make_unique<lane_state>(2 * config_.queue_capacity + 2, config_.queue_capacity));
+            for (auto &batch : s.pool) {
+                batch.orders.resize(batch_size);
+                batch.totals.resize(batch_size);
+                batch.accepted.resize(batch_size);
+                s.free.try_push(&batch);
+            }
+        }
+
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto guarded = [&](auto body) {
+            return [&, body] {
+                try {
+                    body();
+                } catch (...) {
+                    std::lock_guard lock(error_mutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            };
+        };
+
+        std::vector<std::thread> threads;
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            lane_state &s = *state[lane];
+
+            threads.emplace_back(guarded([&, lane] {
+                for (std::size_t b = lane; b < batches; b += lanes) {
+                    order_batch *batch = pop(s.free, failed);
+                    if (batch == nullptr) {
+                        return;
+                    }
+                    std::uint64_t const start = now_ns();
+                    std::size_t const first = b * batch_size;
+                    batch->count = std::min(batch_size, orders.size() - first);
+                    std::size_t rejected = 0;
+                    for (std::size_t i = 0; i < batch->count; ++i) {
+                        batch->orders[i] = orders[first + i];
+                        batch->accepted[i] = is_valid(batch->orders[i]);
+                        rejected += !batch->accepted[i];
+                    }
+                    stats_.rejected.fetch_add(rejected, std::memory_order_relaxed);
+                    count(stats_.validate, batch->count, start);
+                    push(s.to_price, batch, stats_.to_price, failed);
+                }
+                push(s.to_price, nullptr, stats_.to_price, failed);
+            }));
+
+            threads.emplace_back(guarded([&] {
+                while (order_batch *batch = pop(s.to_price, failed)) {
+                    std::uint64_t const start = now_ns();
+                    for (std::size_t i = 0; i < batch->count; ++i) {
+                        batch->totals[i] = batch->accepted[i] ? calculate_total_price(batch->orders[i]) : 0.0;
+                    }
+                    count(stats_.price, batch->count, start);
+                    push(s.to_render, batch, stats_.to_render, failed);
+                }
+                push(s.to_render, nullptr, stats_.to_render, failed);
+            }));
+
+            threads.emplace_back(guarded([&, lane] {
+                while (order_batch *batch = pop(s.to_render, failed)) {
+                    std::uint64_t const start = now_ns();
+                    batch->invoices.clear();
+                    for (std::size_t i = 0; i < batch->count; ++i) {
+                        if (batch->accepted[i]) {
+                            render_invoice(batch->invoices, batch->orders[i], batch->totals[i]);
+                        }
+                    }
+                    sink(lane, std::string_view(batch->invoices));
+                    count(stats_.render, batch->count, start);
+                    s.free.try_push(batch);
+                }
+            }));
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    pipeline_stats const &stats() const { return stats_; }
+
+private:
+    pipeline_config config_;
+    pipeline_stats stats_;
+};
+
+} // namespace n221_exercise
+
+namespace n221_exercise_test
+{
+    using namespace n221_exercise;
+
+    void expect_price(double actual, double expected, char const *what)
+    {
+        if (actual < expected - 1e-9 || actual > expected + 1e-9) {
+            throw std::runtime_error(std::string("Wrong total for ") + what);
+        }
+    }
+
+    void run_tests()
+    {
+        // Test Case 1: Simple order with default settings
+        OrderForm<InventoryItem<"Hat">, DefaultProcessingPolicy, USDollar, CarbonCopyInvoice> order1(2, 5.00);
+        static_assert(std::is_same_v<decltype(order1)::item_type, InventoryItem<"Hat">>);
+        static_assert(std::is_same_v<decltype(order1)::processing_policy, DefaultProcessingPolicy>);
+        static_assert(std::is_same_v<decltype(order1)::currency_type, USDollar>);
+        static_assert(std::is_same_v<decltype(order1)::invoice_format, CarbonCopyInvoice>);
+        expect_price(order1.calculateTotalPrice(), 11.00, "Test Case 1");
+        std::cout << "Test Case 1:\n";
+        order1.printOrder();
+        std::cout << "\n";
+
+        // Test Case 2: Order with expedited processing
+        OrderForm<InventoryItem<"Dress">, ExpeditedProcessingPolicy, USDollar, CarbonCopyInvoice> order2(1, 20.00);
+        static_assert(std::is_same_v<decltype(order2)::processing_policy, ExpeditedProcessingPolicy>);
+        expect_price(order2.calculateTotalPrice(), 25.00, "Test Case 2");
+        std::cout << "Test Case 2:\n";
+        order2.printOrder();
+        std::cout << "\n";
+
+        // Test Case 3: Order with Canadian dollars and typed invoice
+        OrderForm<InventoryItem<"Suit">, DefaultProcessingPolicy, CanadianDollar, TypedInvoice> order3(3, 40.00);
+        static_assert(std::is_same_v<decltype(order3)::currency_type, CanadianDollar>);
+        static_assert(std::is_same_v<decltype(order3)::invoice_format, TypedInvoice>);
+        expect_price(order3.calculateTotalPrice(), 3 * 40.00 * 1.10 * 0.97, "Test Case 3");
+        std::cout << "Test Case 3:\n";
+        order3.printOrder();
+        std::cout << "\n";
+
+        // Test Case 4: Bulk order with discount
+        OrderForm<InventoryItem<"Gloves">, BulkOrderProcessing, USDollar, CarbonCopyInvoice> order4(10, 1.50);
+        static_assert(std::is_same_v<decltype(order4)::processing_policy, BulkOrderProcessing>);
+        expect_price(order4.calculateTotalPrice(), 14.25, "Test Case 4");
+        std::cout << "Test Case 4:\n";
+        order4.printOrder();
+        std::cout << "\n";
+
+        // Test Case 5: Using default template arguments explicitly
+        OrderForm<InventoryItem<"Shirt">> order5(5, 3.00);
+        static_assert(std::is_same_v<decltype(order5)::processing_policy, DefaultProcessingPolicy>);
+        static_assert(std::is_same_v<decltype(order5)::currency_type, USDollar>);
+        static_assert(std::is_same_v<decltype(order5)::invoice_format, CarbonCopyInvoice>);
+        std::cout << "Test Case 5:\n";
+        order5.printOrder();
+        std::cout << "\n";
+
+        // Static Assert demonstrating the concept requirement
+        struct InvalidItem { int getName() { return 1; } }; // Doesn't meet the concept
+        static_assert(!InventoryItemConcept<InvalidItem>, "Intentional fail if concept check is wrong");
+        // The following line should cause a compilation error due to the static_assert in OrderForm
+        // OrderForm<InvalidItem> invalid_order(1, 1.0); // Uncommenting this will cause a compile error
+
+        // Test Case 6: Batch pricing matches per-order pricing exactly, including the scalar tail.
+        using Pricer = BatchPricer<InventoryItem<"Suit">, ExpeditedProcessingPolicy, CanadianDollar>;
+        std::vector<int> quantities;
+        std::vector<double> unit_prices;
+        for (int i = 0; i < 11; ++i) {
+            quantities.push_back(i * 3 - 2);
+            unit_prices.push_back(19.99 + i * 0.37);
+        }
+        std::vector<double> totals(quantities.size());
+        Pricer::price(quantities, unit_prices, totals);
+        for (std::size_t i = 0; i < totals.size(); ++i) {
+            OrderForm<InventoryItem<"Suit">, ExpeditedProcessingPolicy, CanadianDollar> order(quantities[i], unit_prices[i]);
+            if (totals[i] != order.calculateTotalPrice()) {
+                throw std::runtime_error("Test Case 6: batch price differs from OrderForm");
+            }
+        }
+        std::cout << "Test Case 6: batch pricing matches OrderForm\n";
+
+        // Test Case 7: The price table agrees with OrderForm for a few combinations.
+        static_assert(price_table.size() == 60);
+        static_assert(lookup_price_entry(ItemId::Gloves, PolicyId::Bulk, CurrencyId::USDollar, InvoiceFormatId::CarbonCopy).multiplier == OrderForm<InventoryItem<"Gloves">, BulkOrderProcessing>::multiplier);
+        static_assert(lookup_price_entry(ItemId::Suit, PolicyId::Default, CurrencyId::CanadianDollar, InvoiceFormatId::Typed).currency_symbol == "CAD");
+        static_assert(lookup_price_entry(ItemId::Shirt, PolicyId::Expedited, CurrencyId::USDollar, InvoiceFormatId::Typed).item_name == "Shirt");
+        static_assert(lookup_price_entry(ItemId::Hat, PolicyId::Expedited, CurrencyId::USDollar, InvoiceFormatId::Typed).invoice_format == "Typed");
+        static_assert(lookup_price_entry(ItemId::Dress, PolicyId::Bulk, CurrencyId::USDollar, InvoiceFormatId::Typed).processing == "Bulk");
+        RuntimeOrder const runtime3{ItemId::Suit, PolicyId::Default, CurrencyId::CanadianDollar, InvoiceFormatId::Typed, 3, 40.00};
+        if (calculate_total_price(runtime3) != order3.calculateTotalPrice()) {
+            throw std::runtime_error("Test Case 7: table price differs from OrderForm");
+        }
+        std::cout << "Test Case 7: price table matches OrderForm\n";
+
+        // Test Case 8: The pipeline rejects bad orders, prices and renders the rest in order,
+        // and survives a sink slow enough to fill its tiny queues.
+        std::vector<RuntimeOrder> runtime_orders;
+        for (int i = 0; i < 5000; ++i) {
+            runtime_orders.push_back({static_cast<ItemId>(i % 5), static_cast<PolicyId>(i % 3), static_cast<CurrencyId>(i % 2),
+                                      static_cast<InvoiceFormatId>(i / 2 % 2), i % 97 == 0 ? 0 : 1 + i % 7, 2.50 + i % 13});
+        }
+        runtime_orders[10].unit_price = -1.0;
+        runtime_orders[11].policy = static_cast<PolicyId>(7);
+        order_pipeline pipeline({.lanes = 2, .batch_size = 64, .queue_capacity = 2});
+        std::string invoices[2];
+        pipeline.run(runtime_orders, [&](std::size_t lane, std::string_view text) {
+            invoices[lane] += text;
+            if (invoices[lane].size() % 7 == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        });
+
+        std::string expected[2];
+        std::size_t rejected = 0;
+        for (std::size_t i = 0; i < runtime_orders.size(); ++i) {
+            if (order_pipeline::is_valid(runtime_orders[i])) {
+                order_pipeline::render_invoice(expected[i / 64 % 2], runtime_orders[i], calculate_total_price(runtime_orders[i]));
+            } else {
+                ++rejected;
+            }
+        }
+        if (invoices[0] != expected[0] || invoices[1] != expected[1] || pipeline.stats().rejected != rejected || rejected != 54 ||
+            pipeline.stats().render.orders != runtime_orders.size() || pipeline.stats().to_render.max_depth > 2) {
+            throw std::runtime_error("Test Case 8: pipeline output is wrong");
+        }
+        // Order 0 has no quantity, so the first invoice is order 1: 2 x 3.50 marked up 25% in CAD.
+        if (!expected[0].starts_with("Carbon Copy invoice: 2 x Dress (Expedited) = 8.49CAD\n")) {
+            throw std::runtime_error("Test Case 8: unexpected invoice text");
+        }
+        std::cout << "Test Case 8: order pipeline matches sequential processing\n";
+
+        // Test Case 9: A total too large for whole cents is rejected, and a
+        // throwing sink stops the pipeline and reaches the caller.
+        RuntimeOrder const huge{ItemId::Hat, PolicyId::Default, CurrencyId::USDollar, InvoiceFormatId::Typed, 2000000000, 1e11};
+        RuntimeOrder const largest{ItemId::Hat, PolicyId::Default, CurrencyId::USDollar, InvoiceFormatId::Typed, 1000, 8e13};
+        if (order_pipeline::is_valid(huge) || !order_pipeline::is_valid(largest)) {
+            throw std::runtime_error("Test Case 9: total range check is wrong");
+        }
+        order_pipeline failing({.lanes = 2, .batch_size = 16, .queue_capacity = 2});
+        std::atomic<int> sink_calls{0};
+        bool propagated = false;
+        try {
+            failing.run(runtime_orders, [&](std::size_t, std::string_view) {
+                if (sink_calls.fetch_add(1) == 3) {
+                    throw std::runtime_error("sink failed");
+                }
+            });
+        } catch (std::runtime_error const &e) {
+            propagated = std::string_view(e.what()) == "sink failed";
+        }
+        if (!propagated || failing.stats().render.orders >= runtime_orders.size()) {
+            throw std::runtime_error("Test Case 9: sink failure was not propagated");
+        }
+        std::cout << "Test Case 9: pipeline rejects oversized totals and propagates sink failures\n";
+
+        std::cout << "All tests completed.\n";
+    }
+} // namespace n221_exercise_test
+
+namespace n221_exercise_bench
+{
+    using namespace n221_exercise;
+    using Clock = std::chrono::steady_clock;
+
+    double elapsed_ms(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // An end-of-day run of one item, policy and currency: a vector of
+    // OrderForm objects priced one at a time against BatchPricer over columns.
+    void bench_batch_pricer()
+    {
+        constexpr std::size_t n = 10'000'000;
+        using Item = InventoryItem<"Dress">;
+        using Order = OrderForm<Item, ExpeditedProcessingPolicy, CanadianDollar>;
+        using Pricer = BatchPricer<Item, ExpeditedProcessingPolicy, CanadianDollar>;
+
+        std::vector<int> quantities(n);
+        std::vector<double> unit_prices(n);
+        std::vector<Order> orders;
+        orders.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            quantities[i] = static_cast<int>(1 + i % 12);
+            unit_prices[i] = 5.0 + static_cast<double>(i % 400) * 0.25;
+            orders.emplace_back(quantities[i], unit_prices[i]);
+        }
+
+        std::cout << "\n--- Pricing " << n << " orders, ms ---" << std::endl;
+
+        std::vector<double> per_object(n);
+        auto start = Clock::now();
+        for (std::size_t i = 0; i < n; ++i) {
+            per_object[i] = orders[i].calculateTotalPrice();
+        }
+        double const per_object_ms = elapsed_ms(start);
+
+        std::vector<double> batch(n);
+        start = Clock::now();
+        Pricer::price(quantities, unit_prices, batch);
+        double const batch_ms = elapsed_ms(start);
+
+        if (per_object != batch) {
+            throw std::runtime_error("Batch and per-object prices differ");
+        }
+        std::cout << "OrderForm::calculateTotalPrice: " << per_object_ms << std::endl;
+        std::cout << "BatchPricer::price:             " << batch_ms << std::endl;
+    }
+
+    // Orders whose combination is only known at runtime: one indexed load
+    // from price_table against switching to the OrderForm instantiation.
+    // The item and invoice format do not change the price, so the switch
+    // only covers policy and currency.
+    double total_by_switch(RuntimeOrder const &order)
+    {
+        auto for_policy = [&]<typename Policy>() {
+            switch (order.currency) {
+            case CurrencyId::USDollar:
+                return OrderForm<InventoryItem<"Hat">, Policy, USDollar>(order.quantity, order.unit_price).calculateTotalPrice();
+            case CurrencyId::CanadianDollar:
+                return OrderForm<InventoryItem<"Hat">, Policy, CanadianDollar>(order.quantity, order.unit_price).calculateTotalPrice();
+            }
+            throw std::invalid_argument("Unknown currency");
+        };
+        switch (order.policy) {
+        case PolicyId::Default:
+            return for_policy.template operator()<DefaultProcessingPolicy>();
+        case PolicyId::Expedited:
+            return for_policy.template operator()<ExpeditedProcessingPolicy>();
+        case PolicyId::Bulk:
+            return for_policy.template operator()<BulkOrderProcessing>();
+        }
+        throw std::invalid_argument("Unknown processing policy");
+    }
+
+    void bench_price_table()
+    {
+        constexpr std::size_t n = 10'000'000;
+        std::vector<RuntimeOrder> orders(n);
+        std::uint64_t state = 3;
+        for (auto &order : orders) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            order = {static_cast<ItemId>((state >> 33) % 5), static_cast<PolicyId>((state >> 40) % 3), static_cast<CurrencyId>((state >> 45) % 2),
+                     static_cast<InvoiceFormatId>((state >> 50) % 2), static_cast<int>(1 + (state >> 55) % 12), 5.0 + static_cast<double>((state >> 20) % 400) * 0.25};
+        }
+
+        std::cout << "\n--- Runtime-dispatched pricing of " << n << " mixed orders, ms ---" << std::endl;
+
+        std::vector<double> by_switch(n);
+        auto start = Clock::now();
+        for (std::size_t i = 0; i < n; ++i) {
+            by_switch[i] = total_by_switch(orders[i]);
+        }
+        double const switch_ms = elapsed_ms(start);
+
+        std::vector<double> by_table(n);
+        start = Clock::now();
+        for (std::size_t i = 0; i < n; ++i) {
+            by_table[i] = calculate_total_price(orders[i]);
+        }
+        double const table_ms = elapsed_ms(start);
+
+        if (by_switch != by_table) {
+            throw std::runtime_error("Table and switch prices differ");
+        }
+        std::cout << "switch to OrderForm instantiation: " << switch_ms << std::endl;
+        std::cout << "price_table lookup:                " << table_ms << std::endl;
+    }
+
+    // A 10M-order replay through the pipeline, against validating, pricing
+    // and rendering each order in turn on one thread. Invoices go to
+    // /dev/null with one write per batch.
+    void bench_order_pipeline()
+    {
+        constexpr std::size_t n = 10'000'000;
+        std::vector<RuntimeOrder> orders(n);
+        std::uint64_t state = 5;
+        for (auto &order : orders) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            order = {static_cast<ItemId>((state >> 33) % 5), static_cast<PolicyId>((state >> 40) % 3), static_cast<CurrencyId>((state >> 45) % 2),
+                     static_cast<InvoiceFormatId>((state >> 50) % 2), static_cast<int>((state >> 55) % 13), 5.0 + static_cast<double>((state >> 20) % 400) * 0.25};
+        }
+        int const fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "cannot open /dev/null");
+        }
+        auto write_out = [fd](std::string_view text) {
+            if (::write(fd, text.data(), text.size()) < 0) {
+                throw std::runtime_error("write to /dev/null failed");
+            }
+        };
+
+        std::cout << "\n--- Order replay, " << n << " orders (" << std::thread::hardware_concurrency() << " hardware threads) ---" << std::endl;
+
+        {
+            auto const start = Clock::now();
+            std::string invoices;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (order_pipeline::is_valid(orders[i])) {
+                    order_pipeline::render_invoice(invoices, orders[i], calculate_total_price(orders[i]));
+                }
+                if (i % 1024 == 1023) {
+                    write_out(invoices);
+                    invoices.clear();
+                }
+            }
+            write_out(invoices);
+            std::cout << "sequential: " << elapsed_ms(start) << " ms" << std::endl;
+        }
+
+        // Three threads per lane; the default lane count fills the machine.
+        std::vector<std::size_t> lane_counts{1, 2, 4};
+        if (std::find(lane_counts.begin(), lane_counts.end(), pipeline_config{}.lanes) == lane_counts.end()) {
+            lane_counts.push_back(pipeline_config{}.lanes);
+        }
+        for (std::size_t lanes : lane_counts) {
+            order_pipeline pipeline({.lanes = lanes});
+            auto const start = Clock::now();
+            pipeline.run(orders, [&](std::size_t, std::string_view text) { write_out(text); });
+            double const ms = elapsed_ms(start);
+
+            auto const &stats = pipeline.stats();
+            auto stage = [&](char const *name, stage_counters const &counters) {
+                std::cout << "  " << name << counters.orders / (counters.busy_ns / 1e9) / 1e6 << "M orders/s while busy, "
+                          << counters.busy_ns / 1e6 << " ms busy\n";
+            };
+            std::cout << "pipeline, " << lanes << " lane(s): " << ms << " ms, " << n / ms / 1e3 << "M orders/s, " << stats.rejected << " rejected\n";
+            stage("validate: ", stats.validate);
+            stage("price:    ", stats.price);
+            stage("render:   ", stats.render);
+            std::cout << "  queue to price: max depth " << stats.to_price.max_depth << ", " << stats.to_price.full_stalls << " full stalls; to render: max depth "
+                      << stats.to_render.max_depth << ", " << stats.to_render.full_stalls << " full stalls" << std::endl;
+        }
+        ::close(fd);
+    }
+
+    void run_benchmarks()
+    {
+        bench_order_pipeline();
+        bench_price_table();
+        bench_batch_pricer();
+    }
+} // namespace n221_exercise_bench
+
+int main(int argc, char *argv[])
+{
+    n221_exercise_test::run_tests();
 
-int main() {
-    std::cout << "Hello, World!" << std::endl;
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        n221_exercise_bench::run_benchmarks();
+    }
     return 0;
-}
\ No newline at end of file
+}
@@ -1,6 +1,26 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <mutex>
+#include <span>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace n227_radio_factory
 {
@@ -14,6 +34,64 @@ namespace n227_radio_factory
         double resistance;
     };
 
+    // True if keyword occurs in text. With SSE2, 16 candidate positions are
+    // checked at once by comparing the keyword's first and last characters,
+    // and only positions where both match are compared in full.
+    inline bool contains_keyword(std::string_view text, std::string_view keyword)
+    {
+        size_t const k = keyword.size();
+        if (k > text.size())
+        {
+            return false;
+        }
+#if defined(__SSE2__)
+        if (k >= 2)
+        {
+            __m128i const first = _mm_set1_epi8(keyword.front());
+            __m128i const last = _mm_set1_epi8(keyword.back());
+            size_t i = 0;
+            for (; i + k - 1 + 16 <= text.size(); i += 16)
+            {
+                __m128i const starts = _mm_loadu_si128(reinterpret_cast<__m128i const *>(text.data() + i));
+                __m128i const ends = _mm_loadu_si128(reinterpret_cast<__m128i const *>(text.data() + i + k - 1));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(starts, first), _mm_cmpeq_epi8(ends, last))));
+                for (; mask != 0; mask &= mask - 1)
+                {
+                    if (std::memcmp(text.data() + i + std::countr_zero(mask) + 1, keyword.data() + 1, k - 2) == 0)
+                    {
+                        return true;
+                    }
+                }
+            }
+            return text.substr(i).find(keyword) != std::string_view::npos;
+        }
+#endif
+        return text.find(keyword) != std::string_view::npos;
+    }
+
+    // Sets flags[i] when requests[i].description contains keyword; returns how many were set.
+    template <typename Request>
+    size_t classify_requests(std::span<Request const> requests, std::string_view keyword, std::span<std::uint8_t> flags)
+    {
+        size_t flagged = 0;
+        for (size_t i = 0; i < requests.size(); ++i)
+        {
+            flags[i] = contains_keyword(requests[i].description, keyword);
+            flagged += flags[i];
+        }
+        return flagged;
+    }
+
+    // A bin of up to BinCapacity identical components, described by the
+    // component it was stocked with. The stock level is one atomic counter:
+    // retrieve draws the requested quantity with a compare-and-swap loop and
+    // refill adds to it the same way, so any number of assembly-line threads
+    // can share a bin without a mutex. A bin starts full.
+    //
+    // A RequestPolicy may define a static approves(request), or a keyword
+    // that approved requests mention. Stock is drawn only for approved
+    // requests; a declined request goes to handle() without touching the
+    // stock. Stock drawn for a request is put back if handle() throws.
     template <typename ComponentType, size_t BinCapacity, typename RequestPolicy = void>
     class ComponentBin
     {
@@ -24,14 +102,30 @@ namespace n227_radio_factory
             int quantity_requested;
         };
 
+        ComponentBin() = default;
+
+        explicit ComponentBin(ComponentType component) : component_(std::move(component)) {}
+
+        ComponentBin(ComponentBin const &) = delete;
+        ComponentBin &operator=(ComponentBin const &) = delete;
+
         // Provide a default RequestPolicy if none is specified.
+        // Throws std::runtime_error when the bin holds fewer components than requested.
         template <typename U = RequestPolicy>
         typename std::enable_if<std::is_same_v<U, void>, ComponentType>::type
         retrieve(RequestForm const &request)
         {
             // Default policy: No special handling.
-            // TODO: Implement the logic to retrieve the component based on the request for the default policy.
-            return ComponentType{};
+            draw_or_throw(request);
+            try
+            {
+                return component_;
+            }
+            catch (...)
+            {
+                refill(static_cast<size_t>(request.quantity_requested));
+                throw;
+            }
         }
 
         // Overload for custom RequestPolicy. This demonstrates using the third template argument.
@@ -39,20 +133,213 @@ namespace n227_radio_factory
         typename std::enable_if<!std::is_same_v<U, void>, ComponentType>::type
         retrieve(RequestForm const &request)
         {
-            // Apply the custom RequestPolicy.
-            return RequestPolicy::handle(request);
+            // The RequestPolicy decides what to hand out; only approved requests take stock.
+            if (!approves(request))
+            {
+                check_quantity(request);
+                return RequestPolicy::handle(request);
+            }
+            draw_or_throw(request);
+            try
+            {
+                return RequestPolicy::handle(request);
+            }
+            catch (...)
+            {
+                refill(static_cast<size_t>(request.quantity_requested));
+                throw;
+            }
         }
 
+        // Serves a whole batch: out[i] receives the component for requests[i].
+        // The stock for every approved request is drawn with one
+        // compare-and-swap, nothing is drawn if the bin cannot cover it, and
+        // it is all put back if the policy throws. A policy that defines a
+        // keyword and handle_group (and no approves) has every description
+        // classified once, then is called once for the approved group and
+        // once for the rest; any other policy is called per request.
+        void retrieve_batch(std::span<RequestForm const> requests, std::span<ComponentType> out)
+        {
+            if (out.size() < requests.size())
+            {
+                throw std::invalid_argument("ComponentBin: output buffer smaller than the batch");
+            }
+            for (RequestForm const &request : requests)
+            {
+                check_quantity(request);
+            }
+
+            if constexpr (std::is_same_v<RequestPolicy, void>)
+            {
+                size_t const total = draw_batch_or_throw(requests, {});
+                try
+                {
+                    std::fill_n(out.begin(), requests.size(), component_);
+                }
+                catch (...)
+                {
+                    refill(total);
+                    throw;
+                }
+            }
+            else
+            {
+                std::vector<std::uint8_t> approved(requests.size());
+                size_t approved_count = 0;
+                if constexpr (groups_by_keyword)
+                {
+                    approved_count = classify_requests(requests, RequestPolicy::keyword, std::span<std::uint8_t>(approved));
+                }
+                else
+                {
+                    for (size_t i = 0; i < requests.size(); ++i)
+                    {
+                        approved[i] = approves(requests[i]);
+                        approved_count += approved[i];
+                    }
+                }
+                size_t const total = draw_batch_or_throw(requests, approved);
+
+                try
+                {
+                    if constexpr (groups_by_keyword)
+                    {
+                        ComponentType const approved_component = approved_count > 0 ? RequestPolicy::handle_group(true, approved_count) : ComponentType{};
+                        ComponentType const declined_component =
+                            approved_count < requests.size() ? RequestPolicy::handle_group(false, requests.size() - approved_count) : ComponentType{};
+                        for (size_t i = 0; i < requests.size(); ++i)
+                        {
+                            out[i] = approved[i] ? approved_component : declined_component;
+                        }
+                    }
+                    else
+                    {
+                        for (size_t i = 0; i < requests.size(); ++i)
+                        {
+                            out[i] = RequestPolicy::handle(requests[i]);
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    refill(total);
+                    throw;
+                }
+            }
+        }
+
+        // Takes quantity components if the bin holds that many; otherwise
+        // leaves the stock alone and returns false.
+        bool try_draw(size_t quantity)
+        {
+            size_t available = stock_.load(std::memory_order_relaxed);
+            do
+            {
+                if (available < quantity)
+                {
+                    return false;
+                }
+            } while (!stock_.compare_exchange_weak(available, available - quantity, std::memory_order_acq_rel, std::memory_order_relaxed));
+            return true;
+        }
+
+        // Adds up to quantity components without overfilling; returns how many were added.
+        size_t refill(size_t quantity = BinCapacity)
+        {
+            size_t available = stock_.load(std::memory_order_relaxed);
+            size_t added;
+            do
+            {
+                added = std::min(quantity, BinCapacity - available);
+            } while (!stock_.compare_exchange_weak(available, available + added, std::memory_order_acq_rel, std::memory_order_relaxed));
+            return added;
+        }
+
+        size_t stock() const { return stock_.load(std::memory_order_acquire); }
+
+        ComponentType const &component() const { return component_; }
+
         static constexpr size_t capacity() { return BinCapacity; }
+
+    private:
+        static constexpr bool has_approves = requires(RequestForm const &request) {
+            { RequestPolicy::approves(request) } -> std::convertible_to<bool>;
+        };
+        static constexpr bool has_keyword = requires { std::string_view(RequestPolicy::keyword); };
+        static constexpr bool groups_by_keyword =
+            has_keyword && !has_approves && requires { { RequestPolicy::handle_group(true, size_t{}) } -> std::convertible_to<ComponentType>; };
+
+        // Whether the RequestPolicy lets request take stock: its approves()
+        // if it has one, else whether the description contains its keyword,
+        // else always. Batches classify by keyword the same way.
+        static bool approves(RequestForm const &request)
+        {
+            if constexpr (has_approves)
+            {
+                return RequestPolicy::approves(request);
+            }
+            else if constexpr (has_keyword)
+            {
+                return contains_keyword(request.description, RequestPolicy::keyword);
+            }
+            else
+            {
+                return true;
+            }
+        }
+
+        // Draws the summed quantity of the requests marked in approved (all
+        // of them when approved is empty) in one step; returns the amount.
+        size_t draw_batch_or_throw(std::span<RequestForm const> requests, std::span<std::uint8_t const> approved)
+        {
+            size_t total = 0;
+            for (size_t i = 0; i < requests.size(); ++i)
+            {
+                // Multiplying by the flag avoids a branch on a data-dependent mix of flags.
+                size_t const take = approved.empty() ? 1 : approved[i];
+                total += take * static_cast<size_t>(requests[i].quantity_requested);
+            }
+            if (!try_draw(total))
+            {
+                throw std::runtime_error("ComponentBin: not enough stock for the batch");
+            }
+            return total;
+        }
+
+        static void check_quantity(RequestForm const &request)
+        {
+            if (request.quantity_requested <= 0)
+            {
+                throw std::invalid_argument("ComponentBin: quantity_requested must be positive");
+            }
+        }
+
+        void draw_or_throw(RequestForm const &request)
+        {
+            check_quantity(request);
+            if (!try_draw(static_cast<size_t>(request.quantity_requested)))
+            {
+                throw std::runtime_error("ComponentBin: not enough stock for \"" + request.description + "\"");
+            }
+        }
+
+        ComponentType component_{};
+        alignas(64) std::atomic<size_t> stock_{BinCapacity};
     };
 
     // Example of a custom RequestPolicy - demonstrates the third template argument.
     struct SeniorStaffOnlyPolicy
     {
-        static Resistor handle(const ComponentBin<Resistor, 10, SeniorStaffOnlyPolicy>::RequestForm &request)
+        // Requests whose description contains the keyword are approved and
+        // take stock; the rest go to standard processing.
+        static constexpr std::string_view keyword = "Urgent";
+
+        // Works with the RequestForm of any Resistor bin using this policy.
+        template <typename Request>
+        static Resistor handle(Request const &request)
         {
             // Simulate a check if the requester has the required seniority (not implemented).
-            if (request.description.find("Urgent") != std::string::npos)
+            if (contains_keyword(request.description, keyword))
             {
                 //  TODO: Implement the logic for senior staff to retrieve resistors, potentially overriding normal procedures.
                 return Resistor{};
@@ -63,6 +350,16 @@ namespace n227_radio_factory
                 return {}; // Or some default/error handling
             }
         }
+
+        // Batch form of handle: called once for all urgent (approved) requests and once for the rest.
+        static Resistor handle_group(bool urgent, size_t count)
+        {
+            if (!urgent)
+            {
+                std::cout << count << " requests flagged for standard processing." << std::endl;
+            }
+            return Resistor{};
+        }
     };
 
     // Explicit instantiation for integers as ComponentType, a capacity of 5, and the default policy.
@@ -77,6 +374,36 @@ namespace n227_radio_factory
 
 } // namespace n227_radio_factory
 
+// A policy whose handling always fails, for checking that stock is put back.
+struct FailingPolicy
+{
+    template <typename Request>
+    static n227_radio_factory::Resistor handle(Request const &)
+    {
+        throw std::runtime_error("FailingPolicy: handling failed");
+    }
+};
+
+// A component whose copies fail while armed, for checking that stock is put back.
+struct FragileComponent
+{
+    static inline bool fail_copies = false;
+
+    FragileComponent() = default;
+    FragileComponent(FragileComponent const &)
+    {
+        if (fail_copies)
+        {
+            throw std::runtime_error("FragileComponent: copy failed");
+        }
+    }
+    FragileComponent &operator=(FragileComponent const &other)
+    {
+        FragileComponent copy(other);
+        return *this;
+    }
+};
+
 void run_tests()
 {
     using namespace n227_radio_factory;
@@ -86,14 +413,18 @@ void run_tests()
     ComponentBin<int, 5>::RequestForm int_request = {"Needed for circuit A", 2};
     int retrieved_int = int_bin.retrieve(int_request);
     static_assert(std::is_same_v<decltype(retrieved_int), int>, "Test Case 1 Failed: Incorrect return type");
-    // The actual value depends on the TODO implementation.
+    // A default-constructed bin hands out a value-initialised component.
+    if (retrieved_int != 0)
+    {
+        throw std::runtime_error("Test Case 1 Failed: Unexpected component");
+    }
 
     // Test case 2: Resistor bin with SeniorStaffOnlyPolicy
     ComponentBin<Resistor, 10, SeniorStaffOnlyPolicy> resistor_bin_senior;
     ComponentBin<Resistor, 10, SeniorStaffOnlyPolicy>::RequestForm resistor_request_urgent = {"Urgent resistors for assembly line", 5};
     Resistor retrieved_resistor_senior_urgent = resistor_bin_senior.retrieve(resistor_request_urgent);
     static_assert(std::is_same_v<decltype(retrieved_resistor_senior_urgent), Resistor>, "Test Case 2 Failed: Incorrect return type");
-    // The behavior depends on the TODO implementation within SeniorStaffOnlyPolicy.
+    // SeniorStaffOnlyPolicy approves urgent requests, which take stock; the standard request below is declined and takes none.
 
     ComponentBin<Resistor, 10, SeniorStaffOnlyPolicy>::RequestForm resistor_request_standard = {"Standard resistor request", 3};
     Resistor retrieved_resistor_senior_standard = resistor_bin_senior.retrieve(resistor_request_standard);
@@ -104,17 +435,369 @@ void run_tests()
     ComponentBin<Capacitor, 20>::RequestForm capacitor_request = {"Capacitors for filtering", 10};
     Capacitor retrieved_capacitor = capacitor_bin.retrieve(capacitor_request);
     static_assert(std::is_same_v<decltype(retrieved_capacitor), Capacitor>, "Test Case 3 Failed: Incorrect return type");
-    // The actual content of the capacitor depends on the TODO implementation.
+    // The bin was default-constructed, so the capacitor it hands out is empty.
+    if (!retrieved_capacitor.capacitance.empty())
+    {
+        throw std::runtime_error("Test Case 3 Failed: Unexpected component");
+    }
+
+    // Test case 6: Stock accounting. The bins above started full and kept what was not drawn;
+    // the declined standard resistor request drew nothing.
+    if (int_bin.stock() != 3 || resistor_bin_senior.stock() != 5 || capacitor_bin.stock() != 10)
+    {
+        throw std::runtime_error("Test Case 6 Failed: Stock not drawn by quantity_requested");
+    }
+
+    ComponentBin<Resistor, 10, FailingPolicy> failing_bin;
+    bool policy_threw = false;
+    try
+    {
+        failing_bin.retrieve({"Urgent but doomed", 4});
+    }
+    catch (std::runtime_error const &)
+    {
+        policy_threw = true;
+    }
+    if (!policy_threw || failing_bin.stock() != 10)
+    {
+        throw std::runtime_error("Test Case 6 Failed: Stock not restored when the policy threw");
+    }
+
+    ComponentBin<FragileComponent, 6> fragile_bin;
+    std::vector<FragileComponent> fragile_out(2);
+    std::vector<ComponentBin<FragileComponent, 6>::RequestForm> const fragile_batch = {{"Left channel", 2}, {"Right channel", 2}};
+    FragileComponent::fail_copies = true;
+    bool copy_threw = false;
+    try
+    {
+        fragile_bin.retrieve({"Copied out", 3});
+    }
+    catch (std::runtime_error const &)
+    {
+        copy_threw = true;
+    }
+    try
+    {
+        fragile_bin.retrieve_batch(fragile_batch, fragile_out);
+        copy_threw = false;
+    }
+    catch (std::runtime_error const &)
+    {
+    }
+    FragileComponent::fail_copies = false;
+    if (!copy_threw || fragile_bin.stock() != 6)
+    {
+        throw std::runtime_error("Test Case 6 Failed: Stock not restored when the component copy threw");
+    }
+
+    ComponentBin<Resistor, 8> stocked_bin(Resistor{470.0});
+    if (stocked_bin.retrieve({"Tone control", 8}).resistance != 470.0 || stocked_bin.stock() != 0 || stocked_bin.try_draw(1))
+    {
+        throw std::runtime_error("Test Case 6 Failed: Retrieve did not hand out the stocked component");
+    }
+    bool out_of_stock = false;
+    try
+    {
+        stocked_bin.retrieve({"One more", 1});
+    }
+    catch (std::runtime_error const &)
+    {
+        out_of_stock = true;
+    }
+    if (!out_of_stock || stocked_bin.refill(3) != 3 || stocked_bin.refill() != 5 || stocked_bin.refill() != 0 || stocked_bin.stock() != 8)
+    {
+        throw std::runtime_error("Test Case 6 Failed: Empty bin or refill handled wrongly");
+    }
+
+    // Test case 7: Concurrent draws and refills never lose or invent stock.
+    ComponentBin<int, 1000> shared_bin(7);
+    std::atomic<size_t> drawn{0};
+    std::atomic<size_t> refilled{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t)
+    {
+        workers.emplace_back([&, t]
+        {
+            for (int i = 0; i < 20000; ++i)
+            {
+                size_t const quantity = 1 + (i + t) % 3;
+                if (shared_bin.try_draw(quantity))
+                {
+                    drawn += quantity;
+                }
+                else
+                {
+                    refilled += shared_bin.refill(50);
+                }
+            }
+        });
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    if (shared_bin.stock() != 1000 - drawn + refilled)
+    {
+        throw std::runtime_error("Test Case 7 Failed: Concurrent stock accounting is inconsistent");
+    }
+
+    // Test case 8: Batch retrieval classifies each request once and draws the stock once.
+    for (char const *text : {"", "Urgent", "Urgen", "not urgent at all", "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxUrgent", "UrgentUrgent",
+                             "UUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUrgenU Urgen tUrgent.", "Ut Ut Ut Ut Ut Ut Ut Ut Ut Ut Ut Ut Ut Ut Ut Ut Ut"})
+    {
+        if (contains_keyword(text, "Urgent") != (std::string_view(text).find("Urgent") != std::string_view::npos))
+        {
+            throw std::runtime_error(std::string("Test Case 8 Failed: Keyword scan wrong for \"") + text + "\"");
+        }
+    }
+
+    using BatchBin = ComponentBin<Resistor, 1000, SeniorStaffOnlyPolicy>;
+    BatchBin batch_bin(Resistor{220.0});
+    std::vector<BatchBin::RequestForm> batch;
+    for (int i = 0; i < 40; ++i)
+    {
+        batch.push_back({i % 4 == 0 ? "Urgent: line " + std::to_string(i) + " is stopped" : "Routine restock for line " + std::to_string(i), 1 + i % 3});
+    }
+    std::vector<Resistor> served(batch.size(), Resistor{-1.0});
+    std::ostringstream log;
+    std::streambuf *const console = std::cout.rdbuf(log.rdbuf());
+    batch_bin.retrieve_batch(batch, served);
+    std::cout.rdbuf(console);
+    // Only the ten urgent requests (quantities summing to 19) take stock.
+    if (batch_bin.stock() != 1000 - 19 || log.str() != "30 requests flagged for standard processing.\n" ||
+        std::any_of(served.begin(), served.end(), [](Resistor const &r) { return r.resistance != 0.0; }))
+    {
+        throw std::runtime_error("Test Case 8 Failed: Batch retrieval with SeniorStaffOnlyPolicy");
+    }
+
+    // The per-request path approves and draws exactly the same.
+    BatchBin single_bin(Resistor{220.0});
+    std::cout.rdbuf(log.rdbuf());
+    for (auto const &request : batch)
+    {
+        single_bin.retrieve(request);
+    }
+    std::cout.rdbuf(console);
+    if (single_bin.stock() != batch_bin.stock())
+    {
+        throw std::runtime_error("Test Case 8 Failed: Batch and per-request retrieval disagree");
+    }
+
+    ComponentBin<Resistor, 10, FailingPolicy> failing_batch_bin;
+    std::vector<ComponentBin<Resistor, 10, FailingPolicy>::RequestForm> doomed = {{"A", 2}, {"B", 3}};
+    std::vector<Resistor> unused(doomed.size());
+    policy_threw = false;
+    try
+    {
+        failing_batch_bin.retrieve_batch(doomed, unused);
+    }
+    catch (std::runtime_error const &)
+    {
+        policy_threw = true;
+    }
+    if (!policy_threw || failing_batch_bin.stock() != 10)
+    {
+        throw std::runtime_error("Test Case 8 Failed: Batch stock not restored when the policy threw");
+    }
+
+    ComponentBin<int, 5> small_bin(9);
+    std::vector<ComponentBin<int, 5>::RequestForm> too_many = {{"A", 3}, {"B", 3}};
+    std::vector<int> ints(2);
+    bool refused = false;
+    try
+    {
+        small_bin.retrieve_batch(too_many, ints);
+    }
+    catch (std::runtime_error const &)
+    {
+        refused = true;
+    }
+    small_bin.retrieve_batch(std::span(too_many).first(1), ints);
+    if (!refused || small_bin.stock() != 2 || ints[0] != 9)
+    {
+        throw std::runtime_error("Test Case 8 Failed: Batch retrieval stock accounting");
+    }
 
     // Static assert to check the bin capacity (demonstrates the second template argument).
     static_assert(ComponentBin<float, 100>::capacity() == 100, "Test Case 4 Failed: Incorrect capacity");
     static_assert(ComponentBin<Resistor, 50>::capacity() == 50, "Test Case 5 Failed: Incorrect capacity");
 }
 
-int main()
+using bench_clock = std::chrono::steady_clock;
+
+double elapsed_ms(bench_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+}
+
+// The same stock counter behind a mutex, for comparison.
+struct locked_stock
+{
+    std::mutex mutex;
+    size_t stock;
+
+    bool try_draw(size_t quantity)
+    {
+        std::lock_guard lock(mutex);
+        if (stock < quantity)
+        {
+            return false;
+        }
+        stock -= quantity;
+        return true;
+    }
+
+    void refill(size_t capacity)
+    {
+        std::lock_guard lock(mutex);
+        stock = capacity;
+    }
+};
+
+// 1 to 64 assembly-line threads drawing one component at a time from a
+// single bin, refilling it whenever they find it empty.
+void bench_bin_contention()
+{
+    using namespace n227_radio_factory;
+    constexpr size_t draws = 8'000'000;
+    constexpr size_t capacity = 4096;
+
+    auto run = [](size_t threads, auto &&draw, auto &&refill)
+    {
+        std::vector<std::thread> workers;
+        auto const start = bench_clock::now();
+        for (size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]
+            {
+                for (size_t i = t; i < draws; i += threads)
+                {
+                    while (!draw())
+                    {
+                        refill();
+                    }
+                }
+            });
+        }
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+        return draws / elapsed_ms(start) / 1e3;
+    };
+
+    std::cout << "\n--- One bin, million draws/s (" << std::thread::hardware_concurrency() << " hardware threads) ---" << std::endl;
+    for (size_t threads = 1; threads <= 64; threads *= 2)
+    {
+        ComponentBin<Resistor, capacity> bin(Resistor{100.0});
+        double const lock_free = run(threads, [&] { return bin.try_draw(1); }, [&] { bin.refill(); });
+
+        locked_stock locked{{}, capacity};
+        double const mutex = run(threads, [&] { return locked.try_draw(1); }, [&] { locked.refill(capacity); });
+
+        std::cout << threads << " threads: ComponentBin " << lock_free << ", mutex " << mutex << std::endl;
+    }
+}
+
+// Discards everything written to it, so console output costs formatting only.
+struct null_buffer : std::streambuf
+{
+    int overflow(int c) override
+    {
+        return c;
+    }
+};
+
+// 500K requests, about 30% urgent, served one at a time through retrieve and
+// as a single retrieve_batch, plus the keyword scan on its own.
+void bench_batch_retrieval()
+{
+    using namespace n227_radio_factory;
+    constexpr size_t requests = 500'000;
+    constexpr int rounds = 5;
+    using Bin = ComponentBin<Resistor, requests * 3, SeniorStaffOnlyPolicy>;
+
+    std::vector<Bin::RequestForm> batch;
+    batch.reserve(requests);
+    for (size_t i = 0; i < requests; ++i)
+    {
+        std::string description = "Station " + std::to_string(i % 97) + " needs parts for the tuner board";
+        if (i * 7 % 23 < 7)
+        {
+            description.insert(i % 3 == 0 ? 0 : description.size() / 2, "Urgent ");
+        }
+        batch.push_back({std::move(description), 1 + static_cast<int>(i % 3)});
+    }
+
+    Bin bin(Resistor{470.0});
+    std::vector<Resistor> served(requests);
+    null_buffer sink;
+    std::streambuf *const console = std::cout.rdbuf(&sink);
+
+    auto best_of = [&](auto &&body)
+    {
+        double best = 1e300;
+        for (int r = 0; r < rounds; ++r)
+        {
+            bin.refill();
+            auto const start = bench_clock::now();
+            body();
+            best = std::min(best, elapsed_ms(start));
+        }
+        return best;
+    };
+
+    double const per_request = best_of([&]
+    {
+        for (size_t i = 0; i < requests; ++i)
+        {
+            served[i] = bin.retrieve(batch[i]);
+        }
+    });
+    double const batched = best_of([&] { bin.retrieve_batch(batch, served); });
+
+    size_t flagged = 0;
+    double const find_scan = best_of([&]
+    {
+        flagged = 0;
+        for (auto const &request : batch)
+        {
+            flagged += std::string_view(request.description).find(SeniorStaffOnlyPolicy::keyword) != std::string_view::npos;
+        }
+    });
+    size_t simd_flagged = 0;
+    double const simd_scan = best_of([&]
+    {
+        simd_flagged = 0;
+        for (auto const &request : batch)
+        {
+            simd_flagged += contains_keyword(request.description, SeniorStaffOnlyPolicy::keyword);
+        }
+    });
+    std::cout.rdbuf(console);
+
+    std::cout << "\n--- " << requests << " requests (" << flagged << " urgent), best of " << rounds << ", ms ---" << std::endl;
+    std::cout << "retrieve per request: " << per_request << std::endl;
+    std::cout << "retrieve_batch:       " << batched << std::endl;
+    std::cout << "keyword scan, string_view::find: " << find_scan << std::endl;
+    std::cout << "keyword scan, contains_keyword:  " << simd_scan << (simd_flagged == flagged ? "" : " (MISMATCH)") << std::endl;
+}
+
+void run_benchmarks()
+{
+    bench_batch_retrieval();
+    bench_bin_contention();
+}
+
+int main(int argc, char *argv[])
 {
     std::cout << "Running Tests..." << std::endl;
     run_tests();
     std::cout << "Tests Complete." << std::endl;
+
+    if (argc > 1 && std::string(argv[1]) == "--bench")
+    {
+        run_benchmarks();
+    }
     return 0;
 }
\ No newline at end of file
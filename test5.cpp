@@ -1,45 +1,363 @@
 #include <iostream>
 #include <array>
+#include <atomic>
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
 #include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 namespace exercise
 {
+    // Up to two contiguous runs of a circular_buffer; second is empty unless
+    // the run wraps around the end of the storage.
+    template <typename T>
+    struct circular_buffer_segments
+    {
+        std::span<T> first;
+        std::span<T> second;
+
+        constexpr size_t size() const { return first.size() + second.size(); }
+    };
+
     template <typename T, size_t S>
     class circular_buffer
     {
         static_assert(S > 0, "Size of the buffer must be greater than 0");
 
-        T data_[S];
+        // Raw storage: slots hold live objects only between head_ and tail_,
+        // so T need not be default-constructible and an empty ring costs nothing.
+        alignas(T) std::byte storage_[S * sizeof(T)];
         size_t head_ = 0;
         size_t tail_ = 0;
         bool full_ = false;
 
+        // Indices never exceed 2 * S - 1, so one compare replaces the modulo.
+        static constexpr size_t wrap(size_t index)
+        {
+            return index >= S ? index - S : index;
+        }
+
+        // The uninitialized slot at index, for constructing into.
+        T* slot(size_t index)
+        {
+            return reinterpret_cast<T*>(storage_) + index;
+        }
+
+        // The live element at index.
+        T* element(size_t index)
+        {
+            return std::launder(reinterpret_cast<T*>(storage_) + index);
+        }
+
+        T const* element(size_t index) const
+        {
+            return std::launder(reinterpret_cast<T const*>(storage_) + index);
+        }
+
+        void destroy_front(size_t count)
+        {
+            if constexpr (!std::is_trivially_destructible_v<T>)
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    std::destroy_at(element(wrap(tail_ + i)));
+                }
+            }
+        }
+
+        // Copies or moves other's elements into this empty buffer. If an
+        // element constructor throws, the elements built so far are destroyed
+        // and this buffer stays empty.
+        template <typename Buffer>
+        void construct_from(Buffer&& other)
+        {
+            size_t const count = other.size();
+            size_t built = 0;
+            try
+            {
+                for (; built < count; ++built)
+                {
+                    size_t const index = wrap(other.tail_ + built);
+                    if constexpr (std::is_lvalue_reference_v<Buffer>)
+                    {
+                        std::construct_at(slot(index), *other.element(index));
+                    }
+                    else
+                    {
+                        std::construct_at(slot(index), std::move(*other.element(index)));
+                    }
+                }
+            }
+            catch (...)
+            {
+                for (size_t i = 0; i < built; ++i)
+                {
+                    std::destroy_at(element(wrap(other.tail_ + i)));
+                }
+                throw;
+            }
+            head_ = other.head_;
+            tail_ = other.tail_;
+            full_ = other.full_;
+        }
+
     public:
-        constexpr void push(const T& value)
+        circular_buffer() = default;
+
+        circular_buffer(circular_buffer const& other)
+        {
+            construct_from(other);
+        }
+
+        circular_buffer(circular_buffer&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            construct_from(std::move(other));
+        }
+
+        circular_buffer& operator=(circular_buffer const& other)
+        {
+            if (this != &other)
+            {
+                clear();
+                construct_from(other);
+            }
+            return *this;
+        }
+
+        circular_buffer& operator=(circular_buffer&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            if (this != &other)
+            {
+                clear();
+                construct_from(std::move(other));
+            }
+            return *this;
+        }
+
+        ~circular_buffer()
+        {
+            clear();
+        }
+
+        // Constructs a new element in place at the head. When the buffer is
+        // full the oldest element is destroyed first to make room.
+        template <typename... Args>
+        T& emplace(Args&&... args)
         {
-            data_[head_] = value;
             if (full_)
             {
-                tail_ = (tail_ + 1) % S;
+                std::destroy_at(element(tail_));
+                tail_ = wrap(tail_ + 1);
+                full_ = false;
             }
-            head_ = (head_ + 1) % S;
+
+            T* const value = std::construct_at(slot(head_), std::forward<Args>(args)...);
+            head_ = wrap(head_ + 1);
             full_ = head_ == tail_;
+            return *value;
+        }
+
+        void push(const T& value)
+        {
+            emplace(value);
+        }
+
+        void push(T&& value)
+        {
+            emplace(std::move(value));
+        }
+
+        // Moves the oldest element out and destroys its slot. On an empty
+        // buffer returns T{} when T is default-constructible, and throws
+        // std::out_of_range otherwise.
+        T pop()
+        {
+            if (is_empty())
+            {
+                if constexpr (std::is_default_constructible_v<T>)
+                {
+                    return T{};
+                }
+                else
+                {
+                    throw std::out_of_range("pop from an empty circular_buffer");
+                }
+            }
+
+            T* const oldest = element(tail_);
+            T value = std::move(*oldest);
+            std::destroy_at(oldest);
+            full_ = false;
+            tail_ = wrap(tail_ + 1);
+            return value;
         }
 
-        constexpr T pop()
+        // Like pop, but reports an empty buffer with std::nullopt.
+        std::optional<T> try_pop()
         {
-            // TODO: Implement the pop logic to remove and return the value from the tail
-            // If the buffer is empty, return a default-constructed value of type T
             if (is_empty())
             {
-                return T{};
+                return std::nullopt;
             }
 
-            T value = data_[tail_];
+            T* const oldest = element(tail_);
+            std::optional<T> value(std::move(*oldest));
+            std::destroy_at(oldest);
             full_ = false;
-            tail_ = (tail_ + 1) % S;
+            tail_ = wrap(tail_ + 1);
             return value;
-            
+        }
+
+        // Appends all values. Like push, overwrites the oldest elements when
+        // there is not enough free space. Trivially copyable elements are
+        // written with at most two memcpy calls.
+        void push_n(std::span<const T> values)
+        {
+            if constexpr (!std::is_trivially_copyable_v<T>)
+            {
+                for (T const& value : values)
+                {
+                    emplace(value);
+                }
+            }
+            else
+            {
+                if (values.size() >= S)
+                {
+                    std::memcpy(slot(0), values.data() + values.size() - S, S * sizeof(T));
+                    head_ = 0;
+                    tail_ = 0;
+                    full_ = true;
+                    return;
+                }
+
+                size_t const count = values.size();
+                if (count == 0)
+                {
+                    return;
+                }
+
+                size_t const free = S - size();
+                size_t const first = std::min(count, S - head_);
+                std::memcpy(slot(head_), values.data(), first * sizeof(T));
+                std::memcpy(slot(0), values.data() + first, (count - first) * sizeof(T));
+
+                if (count > free)
+                {
+                    tail_ = wrap(tail_ + (count - free));
+                }
+                head_ = wrap(head_ + count);
+                full_ = count >= free;
+            }
+        }
+
+        // Moves up to values.size() elements from the tail into values and
+        // destroys their slots. Returns the number of elements removed.
+        size_t pop_n(std::span<T> values)
+        {
+            size_t const count = std::min(values.size(), size());
+            if (count == 0)
+            {
+                return 0;
+            }
+
+            size_t const first = std::min(count, S - tail_);
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                std::memcpy(values.data(), element(tail_), first * sizeof(T));
+                std::memcpy(values.data() + first, element(0), (count - first) * sizeof(T));
+            }
+            else
+            {
+                std::move(element(tail_), element(tail_) + first, values.data());
+                std::move(element(0), element(0) + (count - first), values.data() + first);
+                destroy_front(count);
+            }
+
+            tail_ = wrap(tail_ + count);
+            full_ = false;
+            return count;
+        }
+
+        // The stored elements, oldest first, for in-place processing. Call
+        // consume() to release what has been processed.
+        circular_buffer_segments<T const> readable_segments() const
+        {
+            size_t const count = size();
+            size_t const first = std::min(count, S - tail_);
+            return {std::span<T const>(element(tail_), first), std::span<T const>(element(0), count - first)};
+        }
+
+        // The free slots, in write order, for producing in place. Call
+        // commit() to publish what has been written. Free slots hold no
+        // objects, so this is only offered for trivially copyable T.
+        circular_buffer_segments<T> writable_segments()
+            requires std::is_trivially_copyable_v<T>
+        {
+            size_t const free = S - size();
+            size_t const first = std::min(free, S - head_);
+            return {std::span<T>(slot(head_), first), std::span<T>(slot(0), free - first)};
+        }
+
+        // Destroys count elements at the tail; count must not exceed size().
+        void consume(size_t const count)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+            destroy_front(count);
+            tail_ = wrap(tail_ + count);
+            full_ = false;
+        }
+
+        // Publishes count elements written through writable_segments(); count
+        // must not exceed the free space.
+        void commit(size_t const count)
+            requires std::is_trivially_copyable_v<T>
+        {
+            if (count == 0)
+            {
+                return;
+            }
+            head_ = wrap(head_ + count);
+            full_ = head_ == tail_;
+        }
+
+        void clear()
+        {
+            destroy_front(size());
+            head_ = 0;
+            tail_ = 0;
+            full_ = false;
         }
 
         constexpr bool is_empty() const
@@ -71,43 +389,2526 @@ namespace exercise
             return size;
         }
 
-        constexpr T const& operator[](size_t const index) const
+        T const& operator[](size_t const index) const
         {
-            return data_[(tail_ + index) % S];
+            return *element(wrap(tail_ + index));
         }
     };
 
-    template <typename T, size_t S>
-    circular_buffer<T, S> make_circular_buffer()
+    // Size of a cache line; head and tail are kept on separate lines so the
+    // producer and the consumer never write to the same line.
+    inline constexpr size_t cache_line_size = 64;
+
+    inline void cpu_relax()
     {
-        return {};
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
     }
-}
 
-int main()
-{
-    using namespace exercise;
+    // Consumer wait strategies for the concurrent buffers. A consumer blocks
+    // in wait_until(ready) until ready() succeeds; the producer calls
+    // notify() after every publish.
 
-    circular_buffer<int, 5> buffer;
+    // Polls ready() with a pause in between. Lowest latency, burns a core.
+    struct busy_spin_wait
+    {
+        template <typename Ready>
+        void wait_until(Ready&& ready)
+        {
+            while (!ready())
+            {
+                cpu_relax();
+            }
+        }
 
-    buffer.push(1);
-    buffer.push(2);
-    buffer.push(3);
+        void notify() noexcept {}
+    };
 
-    std::cout << "Buffer size: " << buffer.size() << "\n";
-    std::cout << "Is buffer full? " << std::boolalpha << buffer.is_full() << "\n";
+    // Spins for a while, then yields the core between polls.
+    struct spin_yield_wait
+    {
+        static constexpr int spin_limit = 128;
 
-    buffer.push(4);
-    buffer.push(5);
-    buffer.push(6); // This should overwrite the first element (1)
+        template <typename Ready>
+        void wait_until(Ready&& ready)
+        {
+            for (int spins = 0; !ready(); ++spins)
+            {
+                if (spins < spin_limit)
+                {
+                    cpu_relax();
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
 
-    std::cout << "Buffer size after pushing 6 elements: " << buffer.size() << "\n";
-    std::cout << "Is buffer full? " << std::boolalpha << buffer.is_full() << "\n";
-    std::cout << "Element at index 0: " << buffer[0] << "\n"; // Should be 2
+        void notify() noexcept {}
+    };
+
+    // Spins briefly, then sleeps in the kernel (std::atomic::wait is a futex
+    // on Linux). The producer pays for a wake-up only when a consumer has
+    // registered as a waiter, so a busy stream costs one extra load.
+    class blocking_wait
+    {
+        static constexpr int spin_limit = 64;
+
+        alignas(cache_line_size) std::atomic<uint32_t> epoch_{0};
+        std::atomic<uint32_t> waiters_{0};
+
+    public:
+        template <typename Ready>
+        void wait_until(Ready&& ready)
+        {
+            for (int spins = 0; spins < spin_limit; ++spins)
+            {
+                if (ready())
+                {
+                    return;
+                }
+                cpu_relax();
+            }
+
+            for (;;)
+            {
+                waiters_.fetch_add(1, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                uint32_t const seen = epoch_.load(std::memory_order_acquire);
+                // Re-check after registering: a publish that missed the
+                // registration is visible here, one that saw it bumps epoch_.
+                if (ready())
+                {
+                    waiters_.fetch_sub(1, std::memory_order_relaxed);
+                    return;
+                }
+                epoch_.wait(seen, std::memory_order_acquire);
+                waiters_.fetch_sub(1, std::memory_order_relaxed);
+
+                if (ready())
+                {
+                    return;
+                }
+            }
+        }
+
+        void notify() noexcept
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiters_.load(std::memory_order_relaxed) != 0)
+            {
+                epoch_.fetch_add(1, std::memory_order_release);
+                epoch_.notify_all();
+            }
+        }
+    };
+
+    // Single-producer/single-consumer ring. One thread may call push, one
+    // other thread may call pop; size/is_empty/is_full are safe from either.
+    // head_ and tail_ are free-running counters, so the full/empty states are
+    // told apart by their difference and no full_ flag is needed. Wait decides
+    // how pop_wait idles while the buffer is empty.
+    template <typename T, size_t S, typename Wait = busy_spin_wait>
+    class spsc_circular_buffer
+    {
+        static_assert(S > 0 && (S & (S - 1)) == 0, "Size of the buffer must be a power of two");
+        static constexpr size_t mask_ = S - 1;
+
+        // Written by the producer, read by the consumer.
+        alignas(cache_line_size) std::atomic<size_t> head_{0};
+        // Producer-local copy of tail_, refreshed only when the ring looks full.
+        size_t cached_tail_ = 0;
 
-    // TODO: Implement the pop logic and then test it here
-    // std::cout << "Popped element: " << buffer.pop() << "\n"; // Should be 2
-    // std::cout << "Buffer size after popping one element: " << buffer.size() << "\n";
+        // Written by the consumer, read by the producer.
+        alignas(cache_line_size) std::atomic<size_t> tail_{0};
+        // Consumer-local copy of head_, refreshed only when the ring looks empty.
+        size_t cached_head_ = 0;
+
+        alignas(cache_line_size) T data_[S];
+
+        Wait wait_;
+
+    public:
+        // Returns false instead of overwriting when the buffer is full.
+        bool push(const T& value)
+        {
+            size_t const head = head_.load(std::memory_order_relaxed);
+            if (head - cached_tail_ == S)
+            {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if (head - cached_tail_ == S)
+                {
+                    return false;
+                }
+            }
+
+            data_[head & mask_] = value;
+            head_.store(head + 1, std::memory_order_release);
+            wait_.notify();
+            return true;
+        }
+
+        // Returns false and leaves value untouched when the buffer is empty.
+        bool pop(T& value)
+        {
+            size_t const tail = tail_.load(std::memory_order_relaxed);
+            if (tail == cached_head_)
+            {
+                cached_head_ = head_.load(std::memory_order_acquire);
+                if (tail == cached_head_)
+                {
+                    return false;
+                }
+            }
+
+            value = data_[tail & mask_];
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Pops the next element, idling according to Wait while the buffer
+        // is empty.
+        void pop_wait(T& value)
+        {
+            wait_.wait_until([&] { return pop(value); });
+        }
+
+        bool is_empty() const
+        {
+            return size() == 0;
+        }
+
+        bool is_full() const
+        {
+            return size() == S;
+        }
+
+        size_t size() const
+        {
+            // Load tail first: head can only grow afterwards, so the
+            // difference never underflows.
+            size_t const tail = tail_.load(std::memory_order_acquire);
+            size_t const head = head_.load(std::memory_order_acquire);
+            return head - tail;
+        }
+
+        static constexpr size_t capacity() { return S; }
+    };
+
+    // What push does when a bounded concurrent buffer has no free slot.
+    enum class overflow_policy
+    {
+        fail_when_full,  // push returns false and the value is dropped
+        overwrite_oldest // push evicts the oldest element, like circular_buffer
+    };
+
+    // Bounded multi-producer/multi-consumer ring after Dmitry Vyukov's design.
+    // Every slot carries a sequence number that tells producers and consumers
+    // whose turn it is, so a thread only contends on the position counter of
+    // its own side and never takes a lock. Wait decides how pop_wait idles
+    // while the buffer is empty.
+    template <typename T, size_t S, overflow_policy Policy = overflow_policy::fail_when_full,
+              typename Wait = busy_spin_wait>
+    class mpmc_circular_buffer
+    {
+        static_assert(S > 1 && (S & (S - 1)) == 0, "Size of the buffer must be a power of two greater than 1");
+        static constexpr size_t mask_ = S - 1;
+
+        struct slot
+        {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        alignas(cache_line_size) std::atomic<size_t> head_{0};
+        alignas(cache_line_size) std::atomic<size_t> tail_{0};
+        alignas(cache_line_size) slot data_[S];
+
+        Wait wait_;
+
+    public:
+        mpmc_circular_buffer()
+        {
+            for (size_t i = 0; i < S; ++i)
+            {
+                data_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        mpmc_circular_buffer(mpmc_circular_buffer const&) = delete;
+        mpmc_circular_buffer& operator=(mpmc_circular_buffer const&) = delete;
+
+        // With fail_when_full, returns false when the buffer is full. With
+        // overwrite_oldest, drops the oldest element to make room and always
+        // returns true.
+        bool push(const T& value)
+        {
+            size_t head = head_.load(std::memory_order_relaxed);
+            slot* cell;
+
+            for (;;)
+            {
+                cell = &data_[head & mask_];
+                size_t const sequence = cell->sequence.load(std::memory_order_acquire);
+                auto const diff = static_cast<std::ptrdiff_t>(sequence - head);
+
+                if (diff == 0)
+                {
+                    if (head_.compare_exchange_weak(head, head + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // The slot still holds the element from one lap ago.
+                    if constexpr (Policy == overflow_policy::fail_when_full)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        T evicted;
+                        if (!pop(evicted))
+                        {
+                            // A consumer has claimed the slot but not released it yet.
+                            cpu_relax();
+                        }
+                        head = head_.load(std::memory_order_relaxed);
+                    }
+                }
+                else
+                {
+                    head = head_.load(std::memory_order_relaxed);
+                }
+            }
+
+            cell->value = value;
+            cell->sequence.store(head + 1, std::memory_order_release);
+            wait_.notify();
+            return true;
+        }
+
+        // Returns false and leaves value untouched when the buffer is empty.
+        bool pop(T& value)
+        {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            slot* cell;
+
+            for (;;)
+            {
+                cell = &data_[tail & mask_];
+                size_t const sequence = cell->sequence.load(std::memory_order_acquire);
+                auto const diff = static_cast<std::ptrdiff_t>(sequence - (tail + 1));
+
+                if (diff == 0)
+                {
+                    if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    tail = tail_.load(std::memory_order_relaxed);
+                }
+            }
+
+            value = std::move(cell->value);
+            cell->sequence.store(tail + S, std::memory_order_release);
+            return true;
+        }
+
+        // Pops the next element, idling according to Wait while the buffer
+        // is empty.
+        void pop_wait(T& value)
+        {
+            wait_.wait_until([&] { return pop(value); });
+        }
+
+        bool is_empty() const
+        {
+            return size() == 0;
+        }
+
+        bool is_full() const
+        {
+            return size() == S;
+        }
+
+        // A snapshot only: other threads may change the count right after.
+        size_t size() const
+        {
+            size_t const tail = tail_.load(std::memory_order_acquire);
+            size_t const head = head_.load(std::memory_order_acquire);
+            if (head <= tail)
+            {
+                return 0;
+            }
+            return std::min(head - tail, S);
+        }
+
+        static constexpr size_t capacity() { return S; }
+    };
+
+    // Byte ring whose pages are mapped twice, back to back, so the bytes at
+    // offset i and i + capacity() are the same memory. Any run of up to
+    // capacity() bytes starting anywhere in the ring is therefore contiguous
+    // and variable-length records never have to be split or copied on wrap.
+    //
+    // The first page of the backing file holds a small header with the
+    // free-running head/tail counters; the ring data follows it. With a file
+    // path the ring survives a restart: reopening the file resumes with the
+    // same contents. Without one the pages come from an anonymous memfd.
+    class mirrored_byte_buffer
+    {
+        struct header
+        {
+            static constexpr uint64_t expected_magic = 0x3146465542524d4dULL; // "MMRBUFF1"
+
+            uint64_t magic;
+            uint64_t capacity;
+            uint64_t head;
+            uint64_t tail;
+        };
+
+        std::byte* region_ = nullptr; // header page followed by the two data views
+        size_t region_size_ = 0;
+        size_t page_size_ = 0;
+        size_t capacity_ = 0;
+        header* header_ = nullptr;
+        std::byte* data_ = nullptr;
+
+        [[noreturn]] static void throw_errno(char const* what)
+        {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        static size_t round_to_pages(size_t bytes, size_t page_size)
+        {
+            return std::max(page_size, (bytes + page_size - 1) / page_size * page_size);
+        }
+
+        // Maps the header page and the data pages of fd twice into one
+        // reserved region. Takes ownership of fd.
+        void map(int fd, size_t capacity)
+        {
+            capacity_ = capacity;
+            region_size_ = page_size_ + 2 * capacity_;
+
+            void* const reserved = ::mmap(nullptr, region_size_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (reserved == MAP_FAILED)
+            {
+                int const error = errno;
+                ::close(fd);
+                errno = error;
+                throw_errno("mmap reserve");
+            }
+            region_ = static_cast<std::byte*>(reserved);
+
+            std::pair<size_t, size_t> const views[] = {
+                {0, page_size_},
+                {page_size_, capacity_},
+                {page_size_ + capacity_, capacity_},
+            };
+            for (auto const& [offset, length] : views)
+            {
+                off_t const file_offset = offset == 0 ? 0 : static_cast<off_t>(page_size_);
+                if (::mmap(region_ + offset, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, file_offset) == MAP_FAILED)
+                {
+                    int const error = errno;
+                    ::close(fd);
+                    unmap();
+                    errno = error;
+                    throw_errno("mmap view");
+                }
+            }
+
+            // The mappings keep the pages alive.
+            ::close(fd);
+            header_ = reinterpret_cast<header*>(region_);
+            data_ = region_ + page_size_;
+        }
+
+        void unmap() noexcept
+        {
+            if (region_ != nullptr)
+            {
+                ::munmap(region_, region_size_);
+            }
+            region_ = nullptr;
+            header_ = nullptr;
+            data_ = nullptr;
+        }
+
+        size_t offset(uint64_t position) const
+        {
+            return static_cast<size_t>(position & (capacity_ - 1));
+        }
+
+    public:
+        // Anonymous ring backed by a memfd. The capacity is rounded up to a
+        // power-of-two multiple of the page size.
+        explicit mirrored_byte_buffer(size_t capacity)
+            : page_size_(static_cast<size_t>(::sysconf(_SC_PAGESIZE)))
+        {
+            size_t const rounded = std::bit_ceil(round_to_pages(capacity, page_size_));
+            int const fd = ::memfd_create("mirrored_byte_buffer", MFD_CLOEXEC);
+            if (fd < 0)
+            {
+                throw_errno("memfd_create");
+            }
+            if (::ftruncate(fd, static_cast<off_t>(page_size_ + rounded)) != 0)
+            {
+                int const error = errno;
+                ::close(fd);
+                errno = error;
+                throw_errno("ftruncate");
+            }
+
+            map(fd, rounded);
+            *header_ = {header::expected_magic, capacity_, 0, 0};
+        }
+
+        // Persistent ring backed by the file at path. A new file is created
+        // with the requested capacity; an existing one is reopened with its
+        // contents and must have been created with the same capacity.
+        mirrored_byte_buffer(std::string const& path, size_t capacity)
+            : page_size_(static_cast<size_t>(::sysconf(_SC_PAGESIZE)))
+        {
+            size_t const rounded = std::bit_ceil(round_to_pages(capacity, page_size_));
+            int const fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd < 0)
+            {
+                throw_errno("open");
+            }
+
+            struct stat info{};
+            if (::fstat(fd, &info) != 0)
+            {
+                int const error = errno;
+                ::close(fd);
+                errno = error;
+                throw_errno("fstat");
+            }
+
+            bool const fresh = info.st_size == 0;
+            if (fresh && ::ftruncate(fd, static_cast<off_t>(page_size_ + rounded)) != 0)
+            {
+                int const error = errno;
+                ::close(fd);
+                errno = error;
+                throw_errno("ftruncate");
+            }
+            if (!fresh && static_cast<size_t>(info.st_size) != page_size_ + rounded)
+            {
+                ::close(fd);
+                throw std::runtime_error("mirrored_byte_buffer: " + path + " was created with a different capacity");
+            }
+
+            map(fd, rounded);
+            if (fresh)
+            {
+                *header_ = {header::expected_magic, capacity_, 0, 0};
+            }
+            else if (header_->magic != header::expected_magic || header_->capacity != capacity_ ||
+                     header_->head - header_->tail > capacity_)
+            {
+                unmap();
+                throw std::runtime_error("mirrored_byte_buffer: " + path + " is not a valid ring file");
+            }
+        }
+
+        mirrored_byte_buffer(mirrored_byte_buffer const&) = delete;
+        mirrored_byte_buffer& operator=(mirrored_byte_buffer const&) = delete;
+
+        mirrored_byte_buffer(mirrored_byte_buffer&& other) noexcept
+            : region_(std::exchange(other.region_, nullptr)),
+              region_size_(other.region_size_),
+              page_size_(other.page_size_),
+              capacity_(other.capacity_),
+              header_(std::exchange(other.header_, nullptr)),
+              data_(std::exchange(other.data_, nullptr))
+        {
+        }
+
+        mirrored_byte_buffer& operator=(mirrored_byte_buffer&& other) noexcept
+        {
+            if (this != &other)
+            {
+                unmap();
+                region_ = std::exchange(other.region_, nullptr);
+                region_size_ = other.region_size_;
+                page_size_ = other.page_size_;
+                capacity_ = other.capacity_;
+                header_ = std::exchange(other.header_, nullptr);
+                data_ = std::exchange(other.data_, nullptr);
+            }
+            return *this;
+        }
+
+        ~mirrored_byte_buffer()
+        {
+            unmap();
+        }
+
+        // Appends all bytes, or nothing when they do not fit. Unlike
+        // circular_buffer::push this never overwrites, since dropping part of
+        // a variable-length record would corrupt the stream.
+        bool write(std::span<const std::byte> bytes)
+        {
+            if (bytes.size() > capacity_ - size())
+            {
+                return false;
+            }
+            std::memcpy(data_ + offset(header_->head), bytes.data(), bytes.size());
+            header_->head += bytes.size();
+            return true;
+        }
+
+        // Moves up to bytes.size() bytes from the tail into bytes. Returns the
+        // number of bytes read.
+        size_t read(std::span<std::byte> bytes)
+        {
+            size_t const count = std::min(bytes.size(), size());
+            std::memcpy(bytes.data(), data_ + offset(header_->tail), count);
+            header_->tail += count;
+            return count;
+        }
+
+        // All stored bytes as one contiguous span. Call consume() to release
+        // what has been processed.
+        std::span<const std::byte> readable() const
+        {
+            return {data_ + offset(header_->tail), size()};
+        }
+
+        // All free space as one contiguous span. Call commit() to publish
+        // what has been written.
+        std::span<std::byte> writable()
+        {
+            return {data_ + offset(header_->head), capacity_ - size()};
+        }
+
+        // Drops count bytes from the tail; count must not exceed size().
+        void consume(size_t const count)
+        {
+            header_->tail += count;
+        }
+
+        // Publishes count bytes written through writable(); count must not
+        // exceed the free space.
+        void commit(size_t const count)
+        {
+            header_->head += count;
+        }
+
+        // Forces a file-backed ring to storage.
+        void flush()
+        {
+            if (::msync(region_, page_size_ + capacity_, MS_SYNC) != 0)
+            {
+                throw_errno("msync");
+            }
+        }
+
+        bool is_empty() const
+        {
+            return header_->head == header_->tail;
+        }
+
+        bool is_full() const
+        {
+            return size() == capacity_;
+        }
+
+        size_t size() const
+        {
+            return static_cast<size_t>(header_->head - header_->tail);
+        }
+
+        size_t capacity() const { return capacity_; }
+    };
+
+    // Which end of a shm_circular_buffer a process attaches as.
+    enum class shm_role
+    {
+        producer,
+        consumer
+    };
+
+    // Single-producer/single-consumer ring shared between processes through a
+    // POSIX shared-memory segment. The segment starts with a fixed header
+    // (layout version, element size and capacity, the attached owners, the
+    // free-running head/tail counters and two futex words) followed by the
+    // slots. An idle side sleeps on a futex and is woken by its peer only
+    // when it has announced that it is waiting.
+    //
+    // Each role is claimed by writing an owner word into the header: the pid
+    // in the high half and the low bits of the process start time in the
+    // low half, so a recycled pid does not pass for the original owner. A
+    // role whose owner no longer exists is taken over, so a restarted
+    // producer or consumer resumes where the crashed one stopped: head/tail
+    // only move after a slot is fully written or read, so nothing is
+    // half-published, and an element a consumer was reading when it died is
+    // delivered again.
+    template <typename T, size_t S>
+    class shm_circular_buffer
+    {
+        static_assert(S > 0 && (S & (S - 1)) == 0, "Size of the buffer must be a power of two");
+        static_assert(std::is_trivially_copyable_v<T>, "Elements are shared between processes byte for byte");
+        static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                      "Atomics in shared memory must be lock-free");
+        static constexpr size_t mask_ = S - 1;
+
+        struct header
+        {
+            static constexpr uint64_t expected_magic = 0x31424343524d4853ULL; // "SHMRCCB1"
+            static constexpr uint32_t current_version = 2;
+
+            std::atomic<uint64_t> magic;
+            uint32_t version;
+            uint32_t element_size;
+            uint64_t capacity;
+            std::atomic<uint64_t> producer_owner;
+            std::atomic<uint64_t> consumer_owner;
+
+            alignas(cache_line_size) std::atomic<uint64_t> head;
+            std::atomic<uint32_t> data_signal;      // futex: bumped when data arrives
+            std::atomic<uint32_t> consumer_waiting;
+
+            alignas(cache_line_size) std::atomic<uint64_t> tail;
+            std::atomic<uint32_t> space_signal;     // futex: bumped when space frees up
+            std::atomic<uint32_t> producer_waiting;
+        };
+
+        static constexpr size_t slots_offset = (sizeof(header) + cache_line_size - 1) / cache_line_size * cache_line_size;
+        static constexpr size_t segment_size = slots_offset + S * sizeof(T);
+
+        std::string name_;
+        shm_role role_;
+        header* header_ = nullptr;
+        T* slots_ = nullptr;
+        uint64_t owner_ = 0;
+
+        [[noreturn]] static void throw_errno(char const* what)
+        {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        // Start time of pid in clock ticks since boot (field 22 of
+        // /proc/<pid>/stat), or 0 if it cannot be read.
+        static uint64_t process_start_time(pid_t pid)
+        {
+            std::string const path = "/proc/" + std::to_string(pid) + "/stat";
+            std::FILE* const file = std::fopen(path.c_str(), "r");
+            if (file == nullptr)
+            {
+                return 0;
+            }
+            char buffer[1024];
+            size_t const length = std::fread(buffer, 1, sizeof(buffer) - 1, file);
+            std::fclose(file);
+            buffer[length] = '\0';
+
+            // The command name in field 2 may contain spaces, so count from its closing parenthesis.
+            char const* field = std::strrchr(buffer, ')');
+            for (int i = 2; field != nullptr && i < 22; ++i)
+            {
+                field = std::strchr(field + 1, ' ');
+            }
+            return field != nullptr ? std::strtoull(field + 1, nullptr, 10) : 0;
+        }
+
+        static uint64_t owner_of(pid_t pid)
+        {
+            return uint64_t{static_cast<uint32_t>(pid)} << 32 | static_cast<uint32_t>(process_start_time(pid));
+        }
+
+        static bool owner_alive(uint64_t owner)
+        {
+            auto const pid = static_cast<pid_t>(owner >> 32);
+            if (pid == 0 || (::kill(pid, 0) != 0 && errno == ESRCH))
+            {
+                return false;
+            }
+            // Same pid, different start time: the pid was reused.
+            return owner_of(pid) == owner;
+        }
+
+        static void futex_wait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout)
+        {
+            auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+            timespec const relative{static_cast<time_t>(seconds.count()), static_cast<long>((timeout - seconds).count())};
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &relative, nullptr, 0);
+        }
+
+        static void futex_wake(std::atomic<uint32_t>& word)
+        {
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+        }
+
+        // Wakes the peer only if it announced that it is about to sleep.
+        static void signal(std::atomic<uint32_t>& waiting, std::atomic<uint32_t>& word)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiting.load(std::memory_order_relaxed) != 0)
+            {
+                word.fetch_add(1, std::memory_order_release);
+                futex_wake(word);
+            }
+        }
+
+        // Sleeps on word until attempt() succeeds or timeout expires.
+        template <typename Attempt>
+        static bool wait_for(Attempt&& attempt, std::atomic<uint32_t>& waiting, std::atomic<uint32_t>& word,
+                             std::chrono::nanoseconds timeout)
+        {
+            auto const deadline = std::chrono::steady_clock::now() + timeout;
+            for (;;)
+            {
+                if (attempt())
+                {
+                    return true;
+                }
+
+                waiting.store(1, std::memory_order_seq_cst);
+                uint32_t const seen = word.load(std::memory_order_acquire);
+                if (attempt())
+                {
+                    waiting.store(0, std::memory_order_relaxed);
+                    return true;
+                }
+
+                auto const remaining = deadline - std::chrono::steady_clock::now();
+                if (remaining <= std::chrono::nanoseconds::zero())
+                {
+                    waiting.store(0, std::memory_order_relaxed);
+                    return false;
+                }
+                futex_wait(word, seen, remaining);
+                waiting.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic<uint64_t>& own_owner() const
+        {
+            return role_ == shm_role::producer ? header_->producer_owner : header_->consumer_owner;
+        }
+
+        std::atomic<uint64_t>& peer_owner() const
+        {
+            return role_ == shm_role::producer ? header_->consumer_owner : header_->producer_owner;
+        }
+
+        void claim_role()
+        {
+            owner_ = owner_of(::getpid());
+            auto& slot = own_owner();
+            uint64_t current = slot.load(std::memory_order_acquire);
+            for (;;)
+            {
+                if (owner_alive(current))
+                {
+                    throw std::runtime_error("shm_circular_buffer: " + name_ + " already has a live " +
+                                             (role_ == shm_role::producer ? "producer" : "consumer"));
+                }
+                // Free, or left behind by a crashed process: take it over.
+                if (slot.compare_exchange_weak(current, owner_, std::memory_order_acq_rel))
+                {
+                    return;
+                }
+            }
+        }
+
+    public:
+        // Attaches to the segment called name (for example "/orders"),
+        // creating and initialising it if it does not exist yet.
+        shm_circular_buffer(std::string name, shm_role role)
+            : name_(std::move(name)), role_(role)
+        {
+            bool created = true;
+            int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+            if (fd < 0 && errno == EEXIST)
+            {
+                created = false;
+                fd = ::shm_open(name_.c_str(), O_RDWR | O_CLOEXEC, 0600);
+            }
+            if (fd < 0)
+            {
+                throw_errno("shm_open");
+            }
+
+            if (created && ::ftruncate(fd, static_cast<off_t>(segment_size)) != 0)
+            {
+                int const error = errno;
+                ::close(fd);
+                errno = error;
+                throw_errno("ftruncate");
+            }
+
+            // The creator may still be sizing the segment.
+            for (int attempt = 0; !created; ++attempt)
+            {
+                struct stat info{};
+                if (::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= segment_size)
+                {
+                    break;
+                }
+                if (attempt == 1000)
+                {
+                    ::close(fd);
+                    throw std::runtime_error("shm_circular_buffer: " + name_ + " was never initialised");
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            void* const mapping = ::mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            int const error = errno;
+            ::close(fd);
+            if (mapping == MAP_FAILED)
+            {
+                errno = error;
+                throw_errno("mmap");
+            }
+
+            header_ = static_cast<header*>(mapping);
+            slots_ = reinterpret_cast<T*>(static_cast<std::byte*>(mapping) + slots_offset);
+
+            if (created)
+            {
+                // The fresh segment is zero-filled; publish the layout last.
+                header_->version = header::current_version;
+                header_->element_size = sizeof(T);
+                header_->capacity = S;
+                header_->magic.store(header::expected_magic, std::memory_order_release);
+            }
+            else
+            {
+                for (int attempt = 0; header_->magic.load(std::memory_order_acquire) != header::expected_magic; ++attempt)
+                {
+                    if (attempt == 1000)
+                    {
+                        ::munmap(header_, segment_size);
+                        throw std::runtime_error("shm_circular_buffer: " + name_ + " was never initialised");
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                if (header_->version != header::current_version || header_->element_size != sizeof(T) || header_->capacity != S)
+                {
+                    ::munmap(header_, segment_size);
+                    throw std::runtime_error("shm_circular_buffer: " + name_ + " has an incompatible layout");
+                }
+            }
+
+            try
+            {
+                claim_role();
+            }
+            catch (...)
+            {
+                ::munmap(header_, segment_size);
+                throw;
+            }
+        }
+
+        shm_circular_buffer(shm_circular_buffer const&) = delete;
+        shm_circular_buffer& operator=(shm_circular_buffer const&) = delete;
+
+        // Releases the role; the segment stays until unlink() is called.
+        ~shm_circular_buffer()
+        {
+            uint64_t self = owner_;
+            own_owner().compare_exchange_strong(self, 0, std::memory_order_acq_rel);
+            ::munmap(header_, segment_size);
+        }
+
+        static void unlink(std::string const& name)
+        {
+            ::shm_unlink(name.c_str());
+        }
+
+        // Producer only. Returns false when the buffer is full.
+        bool push(const T& value)
+        {
+            uint64_t const head = header_->head.load(std::memory_order_relaxed);
+            if (head - header_->tail.load(std::memory_order_acquire) == S)
+            {
+                return false;
+            }
+
+            std::memcpy(&slots_[head & mask_], &value, sizeof(T));
+            header_->head.store(head + 1, std::memory_order_release);
+            signal(header_->consumer_waiting, header_->data_signal);
+            return true;
+        }
+
+        // Consumer only. Returns false when the buffer is empty.
+        bool pop(T& value)
+        {
+            uint64_t const tail = header_->tail.load(std::memory_order_relaxed);
+            if (tail == header_->head.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+
+            std::memcpy(&value, &slots_[tail & mask_], sizeof(T));
+            header_->tail.store(tail + 1, std::memory_order_release);
+            signal(header_->producer_waiting, header_->space_signal);
+            return true;
+        }
+
+        // Producer only. Sleeps while the buffer is full; returns false if
+        // there is still no room after timeout.
+        bool push_wait(const T& value, std::chrono::nanoseconds timeout)
+        {
+            return wait_for([&] { return push(value); }, header_->producer_waiting, header_->space_signal, timeout);
+        }
+
+        // Consumer only. Sleeps while the buffer is empty; returns false if
+        // nothing arrived within timeout. Callers use the timeout to check
+        // peer_alive() periodically.
+        bool pop_wait(T& value, std::chrono::nanoseconds timeout)
+        {
+            return wait_for([&] { return pop(value); }, header_->consumer_waiting, header_->data_signal, timeout);
+        }
+
+        // Whether a live process currently holds the other role.
+        bool peer_alive() const
+        {
+            return owner_alive(peer_owner().load(std::memory_order_acquire));
+        }
+
+        bool is_empty() const
+        {
+            return size() == 0;
+        }
+
+        bool is_full() const
+        {
+            return size() == S;
+        }
+
+        size_t size() const
+        {
+            uint64_t const tail = header_->tail.load(std::memory_order_acquire);
+            uint64_t const head = header_->head.load(std::memory_order_acquire);
+            return static_cast<size_t>(head - tail);
+        }
+
+        static constexpr size_t capacity() { return S; }
+    };
+
+    // Rolling window over the last S values that keeps sum, mean, variance,
+    // min and max up to date on every push, so reading them is O(1) instead
+    // of a walk over the whole window.
+    //
+    // Sum is a running total, mean and variance use Welford's update with
+    // the matching removal step for the evicted value, and min/max come from
+    // monotonic deques of (value, sequence) pairs, which makes push amortised
+    // O(1). Integer windows take the mean from the exact running sum. All
+    // windows are resynchronised from the stored values now and then to shed
+    // the rounding drift that add/remove pairs leave in the double m2 (and,
+    // for floating-point values, in the sum and mean).
+    template <typename T, size_t S>
+    class windowed_aggregate
+    {
+        static_assert(std::is_arithmetic_v<T>, "Window values must be arithmetic");
+
+    public:
+        using sum_type = std::conditional_t<std::is_floating_point_v<T>, double,
+                                            std::conditional_t<std::is_signed_v<T>, long long, unsigned long long>>;
+
+    private:
+        // Values are accumulated this many at a time in independent lanes,
+        // which the compiler maps onto SIMD registers.
+        static constexpr size_t lanes = 8;
+        static constexpr uint64_t resync_interval = std::max<uint64_t>(uint64_t{1} << 16, 8 * S);
+
+        struct entry
+        {
+            T value;
+            uint64_t sequence;
+        };
+
+        // Fixed-capacity deque of entries with both ends open.
+        class monotonic_deque
+        {
+            std::unique_ptr<entry[]> entries_ = std::make_unique<entry[]>(S);
+            size_t front_ = 0;
+            size_t count_ = 0;
+
+            static size_t wrap(size_t index) { return index >= S ? index - S : index; }
+
+        public:
+            bool empty() const { return count_ == 0; }
+            entry const& front() const { return entries_[front_]; }
+            entry const& back() const { return entries_[wrap(front_ + count_ - 1)]; }
+
+            void pop_front()
+            {
+                front_ = wrap(front_ + 1);
+                --count_;
+            }
+
+            void pop_back() { --count_; }
+
+            void push_back(entry const& item)
+            {
+                entries_[wrap(front_ + count_)] = item;
+                ++count_;
+            }
+
+        };
+
+        circular_buffer<T, S> values_;
+        uint64_t next_sequence_ = 0;
+        uint64_t evictions_since_resync_ = 0;
+        sum_type sum_{};
+        double mean_ = 0.0;
+        double m2_ = 0.0;
+        monotonic_deque min_;
+        monotonic_deque max_;
+
+        void add(T value)
+        {
+            sum_ += static_cast<sum_type>(value);
+
+            double const n = static_cast<double>(values_.size());
+            double const delta = value - mean_;
+            mean_ = next_mean(mean_ + delta / n, n);
+            m2_ += delta * (value - mean_);
+
+            entry const item{value, next_sequence_++};
+            while (!min_.empty() && min_.back().value >= value)
+            {
+                min_.pop_back();
+            }
+            min_.push_back(item);
+            while (!max_.empty() && max_.back().value <= value)
+            {
+                max_.pop_back();
+            }
+            max_.push_back(item);
+        }
+
+        // The mean after an update to count values: Welford's estimate for
+        // floating-point windows, the exact sum_ / count for integer ones.
+        double next_mean(double welford, double count) const
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                return welford;
+            }
+            else
+            {
+                return static_cast<double>(sum_) / count;
+            }
+        }
+
+        void evict(T value, uint64_t sequence)
+        {
+            sum_ -= static_cast<sum_type>(value);
+
+            double const n = static_cast<double>(values_.size());
+            if (n <= 1)
+            {
+                mean_ = 0.0;
+                m2_ = 0.0;
+            }
+            else
+            {
+                double const delta = value - mean_;
+                mean_ = next_mean(mean_ - delta / (n - 1), n - 1);
+                m2_ -= delta * (value - mean_);
+            }
+
+            if (!min_.empty() && min_.front().sequence == sequence)
+            {
+                min_.pop_front();
+            }
+            if (!max_.empty() && max_.front().sequence == sequence)
+            {
+                max_.pop_front();
+            }
+        }
+
+        // Sum of a contiguous run, lanes values at a time.
+        static sum_type accumulate(std::span<T const> values)
+        {
+            sum_type lane_total[lanes] = {};
+            size_t i = 0;
+            for (; i + lanes <= values.size(); i += lanes)
+            {
+                for (size_t lane = 0; lane < lanes; ++lane)
+                {
+                    lane_total[lane] += static_cast<sum_type>(values[i + lane]);
+                }
+            }
+
+            sum_type total{};
+            for (sum_type const lane : lane_total)
+            {
+                total += lane;
+            }
+            for (; i < values.size(); ++i)
+            {
+                total += static_cast<sum_type>(values[i]);
+            }
+            return total;
+        }
+
+        // Sum of squared deviations from mean over a contiguous run.
+        static double squared_deviations(std::span<T const> values, double mean)
+        {
+            double lane_total[lanes] = {};
+            size_t i = 0;
+            for (; i + lanes <= values.size(); i += lanes)
+            {
+                for (size_t lane = 0; lane < lanes; ++lane)
+                {
+                    double const delta = values[i + lane] - mean;
+                    lane_total[lane] += delta * delta;
+                }
+            }
+
+            double total = 0.0;
+            for (double const lane : lane_total)
+            {
+                total += lane;
+            }
+            for (; i < values.size(); ++i)
+            {
+                double const delta = values[i] - mean;
+                total += delta * delta;
+            }
+            return total;
+        }
+
+    public:
+        // Appends value, evicting the oldest value once the window holds S.
+        void push(T value)
+        {
+            if (values_.is_full())
+            {
+                evict(values_[0], next_sequence_ - S);
+                ++evictions_since_resync_;
+            }
+
+            values_.push(value);
+            add(value);
+
+            if (evictions_since_resync_ >= resync_interval)
+            {
+                resync();
+            }
+        }
+
+        // Recomputes sum, mean and variance from the stored values with a
+        // batch pass over the window's (at most two) contiguous segments. The
+        // min/max deques hold copies of values, so they never drift.
+        void resync()
+        {
+            evictions_since_resync_ = 0;
+            sum_ = sum_type{};
+            mean_ = 0.0;
+            m2_ = 0.0;
+
+            size_t const count = values_.size();
+            if (count == 0)
+            {
+                return;
+            }
+
+            auto const segments = values_.readable_segments();
+            sum_ = accumulate(segments.first) + accumulate(segments.second);
+
+            mean_ = static_cast<double>(sum_) / count;
+            m2_ = squared_deviations(segments.first, mean_) + squared_deviations(segments.second, mean_);
+        }
+
+        size_t size() const { return values_.size(); }
+        bool is_empty() const { return values_.is_empty(); }
+        bool is_full() const { return values_.is_full(); }
+        T const& operator[](size_t const index) const { return values_[index]; }
+
+        sum_type sum() const { return sum_; }
+        double mean() const { return mean_; }
+
+        // Population variance of the window; 0 when it holds fewer than two values.
+        double variance() const
+        {
+            return values_.size() < 2 ? 0.0 : std::max(0.0, m2_ / values_.size());
+        }
+
+        // Like circular_buffer::pop, min and max return T{} on an empty window.
+        T min() const { return min_.empty() ? T{} : min_.front().value; }
+        T max() const { return max_.empty() ? T{} : max_.front().value; }
+
+        static constexpr size_t capacity() { return S; }
+    };
+
+    template <typename T, size_t S>
+    circular_buffer<T, S> make_circular_buffer()
+    {
+        return {};
+    }
+}
+
+namespace exercise_tests
+{
+    using namespace exercise;
+
+    void test_circular_buffer_batches()
+    {
+        circular_buffer<int, 5> buffer;
+        int const first[] = {1, 2, 3};
+        buffer.push_n(first);
+        buffer.pop();
+
+        // Wraps around the end of the storage: tail at 1, head back at 1.
+        int const second[] = {4, 5, 6};
+        buffer.push_n(second);
+        if (!buffer.is_full() || buffer[0] != 2 || buffer[4] != 6)
+        {
+            throw std::runtime_error("push_n failed to wrap");
+        }
+
+        auto const readable = buffer.readable_segments();
+        if (readable.first.size() != 4 || readable.second.size() != 1 || readable.second[0] != 6)
+        {
+            throw std::runtime_error("readable_segments returned the wrong split");
+        }
+
+        // Overflow drops the oldest elements, exactly like repeated push.
+        int const third[] = {7, 8};
+        buffer.push_n(third);
+        int out[5] = {};
+        if (buffer.pop_n(out) != 5 || out[0] != 4 || out[4] != 8 || !buffer.is_empty())
+        {
+            throw std::runtime_error("push_n overflow or pop_n failed");
+        }
+
+        auto writable = buffer.writable_segments();
+        if (writable.size() != 5)
+        {
+            throw std::runtime_error("writable_segments should cover the whole empty buffer");
+        }
+        writable.first[0] = 9;
+        buffer.commit(1);
+        buffer.consume(1);
+        if (!buffer.is_empty())
+        {
+            throw std::runtime_error("commit/consume failed");
+        }
+
+        std::cout << "Circular buffer batch tests passed\n";
+    }
+
+    // A move-only type with no default constructor that counts live objects.
+    struct tracked_message
+    {
+        static inline int live = 0;
+        std::unique_ptr<int> payload;
+
+        explicit tracked_message(int value) : payload(std::make_unique<int>(value)) { ++live; }
+        tracked_message(tracked_message&& other) noexcept : payload(std::move(other.payload)) { ++live; }
+        tracked_message& operator=(tracked_message&&) = default;
+        ~tracked_message() { --live; }
+    };
+
+    // Copyable, but the copy constructor throws once copies_left runs out.
+    struct fragile_message
+    {
+        static inline int live = 0;
+        static inline int copies_left = 0;
+        int value;
+
+        explicit fragile_message(int v) : value(v) { ++live; }
+        fragile_message(fragile_message const& other) : value(other.value)
+        {
+            if (copies_left-- == 0)
+            {
+                throw std::runtime_error("fragile_message copy failed");
+            }
+            ++live;
+        }
+        fragile_message& operator=(fragile_message const&) = default;
+        ~fragile_message() { --live; }
+    };
+
+    void test_circular_buffer_storage()
+    {
+        static_assert(!std::is_default_constructible_v<tracked_message>);
+
+        {
+            circular_buffer<tracked_message, 3> buffer;
+            if (tracked_message::live != 0)
+            {
+                throw std::runtime_error("An empty buffer should not construct elements");
+            }
+
+            for (int i = 1; i <= 4; ++i)
+            {
+                buffer.emplace(i);
+            }
+
+            // The fourth emplace destroyed the first element.
+            if (tracked_message::live != 3 || *buffer[0].payload != 2)
+            {
+                throw std::runtime_error("emplace should overwrite and destroy the oldest element");
+            }
+
+            tracked_message moved = buffer.pop();
+            if (*moved.payload != 2 || tracked_message::live != 3 || buffer.size() != 2)
+            {
+                throw std::runtime_error("pop should move the element out and destroy its slot");
+            }
+
+            auto next = buffer.try_pop();
+            if (!next || *next->payload != 3)
+            {
+                throw std::runtime_error("try_pop should return the oldest element");
+            }
+
+            circular_buffer<tracked_message, 3> other(std::move(buffer));
+            other.pop();
+            if (other.try_pop() || !other.is_empty())
+            {
+                throw std::runtime_error("try_pop on an empty buffer should return nullopt");
+            }
+
+            bool threw = false;
+            try
+            {
+                other.pop();
+            }
+            catch (std::out_of_range const&)
+            {
+                threw = true;
+            }
+            if (!threw)
+            {
+                throw std::runtime_error("pop on an empty buffer of a non-default-constructible type should throw");
+            }
+
+            other.emplace(5);
+            other.emplace(6);
+        }
+
+        if (tracked_message::live != 0)
+        {
+            throw std::runtime_error("Destroying the buffer should destroy the remaining elements");
+        }
+
+        {
+            circular_buffer<fragile_message, 4> source;
+            for (int i = 1; i <= 4; ++i)
+            {
+                source.emplace(i);
+            }
+
+            fragile_message::copies_left = 2;
+            bool threw = false;
+            try
+            {
+                circular_buffer<fragile_message, 4> copy(source);
+            }
+            catch (std::runtime_error const&)
+            {
+                threw = true;
+            }
+            if (!threw || fragile_message::live != 4)
+            {
+                throw std::runtime_error("A failed copy should destroy the elements it already built");
+            }
+
+            circular_buffer<fragile_message, 4> target;
+            target.emplace(9);
+            fragile_message::copies_left = 1;
+            threw = false;
+            try
+            {
+                target = source;
+            }
+            catch (std::runtime_error const&)
+            {
+                threw = true;
+            }
+            if (!threw || fragile_message::live != 4 || !target.is_empty())
+            {
+                throw std::runtime_error("A failed copy assignment should leave the target empty");
+            }
+
+            fragile_message::copies_left = 4;
+            target = source;
+            if (target.size() != 4 || target[3].value != 4 || fragile_message::live != 8)
+            {
+                throw std::runtime_error("Copy assignment should copy every element");
+            }
+        }
+
+        if (fragile_message::live != 0)
+        {
+            throw std::runtime_error("Destroying the buffers should destroy every copied element");
+        }
+
+        std::cout << "Circular buffer storage tests passed\n";
+    }
+
+    void test_mirrored_byte_buffer()
+    {
+        mirrored_byte_buffer ring(1);
+        size_t const capacity = ring.capacity();
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0 || !ring.is_empty())
+        {
+            throw std::runtime_error("mirrored buffer should start empty with a power-of-two capacity");
+        }
+
+        // Park the tail near the end so the next record straddles the wrap.
+        std::vector<std::byte> filler(capacity - 8, std::byte{1});
+        ring.write(filler);
+        ring.consume(filler.size());
+
+        std::vector<std::byte> record(32);
+        for (size_t i = 0; i < record.size(); ++i)
+        {
+            record[i] = static_cast<std::byte>(i);
+        }
+        if (!ring.write(record))
+        {
+            throw std::runtime_error("mirrored buffer rejected a record that fits");
+        }
+
+        auto const readable = ring.readable();
+        if (readable.size() != record.size() || !std::equal(readable.begin(), readable.end(), record.begin()))
+        {
+            throw std::runtime_error("a wrapped record should read back as one contiguous span");
+        }
+        ring.consume(readable.size());
+
+        std::vector<std::byte> too_big(capacity + 1);
+        if (ring.write(too_big) || !ring.write(std::span(too_big).first(capacity)) || !ring.is_full())
+        {
+            throw std::runtime_error("mirrored buffer full/size semantics are wrong");
+        }
+
+        // A file-backed ring keeps its contents across reopening.
+        std::string const path = "/tmp/test5_mirrored_byte_buffer." + std::to_string(::getpid());
+        {
+            mirrored_byte_buffer persistent(path, 1);
+            persistent.write(record);
+            persistent.flush();
+        }
+        {
+            mirrored_byte_buffer reopened(path, 1);
+            std::vector<std::byte> restored(record.size());
+            if (reopened.size() != record.size() || reopened.read(restored) != record.size() || restored != record)
+            {
+                std::remove(path.c_str());
+                throw std::runtime_error("file-backed mirrored buffer did not survive reopening");
+            }
+        }
+        std::remove(path.c_str());
+
+        std::cout << "Mirrored byte buffer tests passed\n";
+    }
+
+    void test_shm_circular_buffer()
+    {
+        using channel = shm_circular_buffer<uint64_t, 64>;
+        std::string const name = "/test5_shm_circular_buffer." + std::to_string(::getpid());
+        channel::unlink(name);
+
+        constexpr uint64_t count = 20000;
+        {
+            channel consumer(name, shm_role::consumer);
+
+            pid_t const child = ::fork();
+            if (child == 0)
+            {
+                channel producer(name, shm_role::producer);
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    producer.push_wait(i, std::chrono::seconds(10));
+                }
+                ::_exit(0);
+            }
+
+            for (uint64_t expected = 0; expected < count; ++expected)
+            {
+                uint64_t got = 0;
+                if (!consumer.pop_wait(got, std::chrono::seconds(10)) || got != expected)
+                {
+                    ::kill(child, SIGKILL);
+                    ::waitpid(child, nullptr, 0);
+                    channel::unlink(name);
+                    throw std::runtime_error("shared-memory channel lost or reordered a message");
+                }
+            }
+            ::waitpid(child, nullptr, 0);
+
+            if (consumer.peer_alive())
+            {
+                channel::unlink(name);
+                throw std::runtime_error("the exited producer should not be reported alive");
+            }
+        }
+
+        // A producer that dies without detaching leaves its owner word behind; the
+        // next producer takes the role over and keeps the queued messages.
+        pid_t const crashed = ::fork();
+        if (crashed == 0)
+        {
+            channel producer(name, shm_role::producer);
+            producer.push(42);
+            ::_exit(0); // skips the destructor, like a crash
+        }
+        ::waitpid(crashed, nullptr, 0);
+
+        {
+            channel producer(name, shm_role::producer);
+            producer.push(43);
+            channel consumer(name, shm_role::consumer);
+            uint64_t first = 0;
+            uint64_t second = 0;
+            if (!consumer.pop(first) || !consumer.pop(second) || first != 42 || second != 43)
+            {
+                channel::unlink(name);
+                throw std::runtime_error("shared-memory channel did not recover from a crashed producer");
+            }
+
+            bool rejected = false;
+            try
+            {
+                channel duplicate(name, shm_role::consumer);
+            }
+            catch (std::runtime_error const&)
+            {
+                rejected = true;
+            }
+            if (!rejected)
+            {
+                channel::unlink(name);
+                throw std::runtime_error("a second live consumer should be rejected");
+            }
+        }
+        channel::unlink(name);
+
+        std::cout << "Shared-memory circular buffer tests passed\n";
+    }
+
+    // Brute-force statistics over the window, as callers computed them before.
+    template <typename Window>
+    void check_window(Window const& window, char const* label)
+    {
+        double sum = 0.0;
+        auto low = window[0];
+        auto high = window[0];
+        for (size_t i = 0; i < window.size(); ++i)
+        {
+            sum += window[i];
+            low = std::min(low, window[i]);
+            high = std::max(high, window[i]);
+        }
+        double const mean = sum / window.size();
+        double squares = 0.0;
+        for (size_t i = 0; i < window.size(); ++i)
+        {
+            squares += (window[i] - mean) * (window[i] - mean);
+        }
+        double const variance = squares / window.size();
+
+        bool const matches = std::abs(static_cast<double>(window.sum()) - sum) <= 1e-6 * (1 + std::abs(sum)) &&
+                             std::abs(window.mean() - mean) <= 1e-6 * (1 + std::abs(mean)) &&
+                             std::abs(window.variance() - variance) <= 1e-6 * (1 + variance) &&
+                             window.min() == low && window.max() == high;
+        if (!matches)
+        {
+            throw std::runtime_error(std::string("windowed_aggregate statistics diverged: ") + label);
+        }
+    }
+
+    void test_windowed_aggregate()
+    {
+        windowed_aggregate<int, 4> window;
+        if (window.min() != 0 || window.mean() != 0.0)
+        {
+            throw std::runtime_error("an empty window should report zeroes");
+        }
+
+        for (int value : {5, 1, 4, 2, 8, 3})
+        {
+            window.push(value);
+        }
+        // Window is now {4, 2, 8, 3}.
+        if (window.sum() != 17 || window.min() != 2 || window.max() != 8 || window.size() != 4)
+        {
+            throw std::runtime_error("windowed_aggregate evicted the wrong values");
+        }
+
+        std::mt19937 generator(7);
+        std::uniform_int_distribution<int> integers(-1000, 1000);
+        windowed_aggregate<int, 37> integer_window;
+        for (int i = 0; i < 5000; ++i)
+        {
+            integer_window.push(integers(generator));
+            check_window(integer_window, "int");
+        }
+
+        // Large integers with a small spread: Welford's double mean and m2
+        // pick up rounding error on every add/remove pair.
+        std::uniform_int_distribution<long long> large(1'000'000'000'000LL, 1'000'000'001'000LL);
+        windowed_aggregate<long long, 16> large_window;
+        for (int i = 0; i < 300000; ++i)
+        {
+            large_window.push(large(generator));
+        }
+        check_window(large_window, "long long after many evictions");
+
+        std::normal_distribution<double> reals(100.0, 15.0);
+        windowed_aggregate<double, 100> real_window;
+        for (int i = 0; i < 5000; ++i)
+        {
+            real_window.push(reals(generator));
+        }
+        check_window(real_window, "double");
+        real_window.resync();
+        check_window(real_window, "double after resync");
+
+        std::cout << "Windowed aggregate tests passed\n";
+    }
+
+    void test_spsc_circular_buffer()
+    {
+        spsc_circular_buffer<int, 4> ring;
+        int value = 0;
+
+        if (!ring.is_empty() || ring.pop(value))
+        {
+            throw std::runtime_error("SPSC buffer should start empty");
+        }
+
+        for (int i = 1; i <= 4; ++i)
+        {
+            ring.push(i);
+        }
+
+        if (!ring.is_full() || ring.push(5))
+        {
+            throw std::runtime_error("SPSC buffer should reject a push when full");
+        }
+
+        if (!ring.pop(value) || value != 1 || ring.size() != 3)
+        {
+            throw std::runtime_error("SPSC buffer pop failed");
+        }
+
+        // Two threads: every value must arrive exactly once and in order.
+        spsc_circular_buffer<int, 64> shared;
+        constexpr int count = 100000;
+        std::thread producer([&shared] {
+            for (int i = 0; i < count; ++i)
+            {
+                while (!shared.push(i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        for (int expected = 0; expected < count; ++expected)
+        {
+            int got = -1;
+            while (!shared.pop(got))
+            {
+                std::this_thread::yield();
+            }
+            if (got != expected)
+            {
+                producer.join();
+                throw std::runtime_error("SPSC buffer delivered values out of order");
+            }
+        }
+        producer.join();
+
+        std::cout << "SPSC circular buffer tests passed\n";
+    }
+
+    void test_mpmc_circular_buffer()
+    {
+        mpmc_circular_buffer<int, 4> rejecting;
+        for (int i = 1; i <= 4; ++i)
+        {
+            rejecting.push(i);
+        }
+
+        if (!rejecting.is_full() || rejecting.push(5))
+        {
+            throw std::runtime_error("MPMC buffer should reject a push when full");
+        }
+
+        mpmc_circular_buffer<int, 4, overflow_policy::overwrite_oldest> overwriting;
+        for (int i = 1; i <= 6; ++i)
+        {
+            overwriting.push(i);
+        }
+
+        int value = 0;
+        if (overwriting.size() != 4 || !overwriting.pop(value) || value != 3)
+        {
+            throw std::runtime_error("MPMC buffer should overwrite the oldest element");
+        }
+
+        // Several producers and consumers: every value arrives exactly once.
+        constexpr int producers = 3;
+        constexpr int consumers = 3;
+        constexpr int per_producer = 50000;
+        mpmc_circular_buffer<int, 128> shared;
+        std::vector<std::atomic<int>> seen(producers * per_producer);
+        std::atomic<int> received{0};
+        std::vector<std::thread> threads;
+
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&shared, p] {
+                for (int i = 0; i < per_producer; ++i)
+                {
+                    while (!shared.push(p * per_producer + i))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        for (int c = 0; c < consumers; ++c)
+        {
+            threads.emplace_back([&] {
+                int got = 0;
+                while (received.load() < producers * per_producer)
+                {
+                    if (shared.pop(got))
+                    {
+                        seen[got].fetch_add(1);
+                        received.fetch_add(1);
+                    }
+                    else
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        if (std::any_of(seen.begin(), seen.end(), [](auto const& count) { return count.load() != 1; }))
+        {
+            throw std::runtime_error("MPMC buffer lost or duplicated a value");
+        }
+
+        std::cout << "MPMC circular buffer tests passed\n";
+    }
+
+    template <typename Wait>
+    void check_wait_strategy(char const* label)
+    {
+        spsc_circular_buffer<int, 16, Wait> spsc;
+        mpmc_circular_buffer<int, 16, overflow_policy::fail_when_full, Wait> mpmc;
+        constexpr int count = 4000;
+
+        std::thread producer([&] {
+            for (int i = 0; i < count; ++i)
+            {
+                while (!spsc.push(i))
+                {
+                    std::this_thread::yield();
+                }
+                while (!mpmc.push(i))
+                {
+                    std::this_thread::yield();
+                }
+                if (i % 500 == 0)
+                {
+                    // Let the consumer run dry and go to sleep now and then.
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+        });
+
+        bool ordered = true;
+        for (int expected = 0; expected < count; ++expected)
+        {
+            int from_spsc = -1;
+            int from_mpmc = -1;
+            spsc.pop_wait(from_spsc);
+            mpmc.pop_wait(from_mpmc);
+            ordered = ordered && from_spsc == expected && from_mpmc == expected;
+        }
+        producer.join();
+
+        if (!ordered)
+        {
+            throw std::runtime_error(std::string("pop_wait delivered the wrong value with ") + label);
+        }
+    }
+
+    void test_wait_strategies()
+    {
+        check_wait_strategy<busy_spin_wait>("busy_spin_wait");
+        check_wait_strategy<spin_yield_wait>("spin_yield_wait");
+        check_wait_strategy<blocking_wait>("blocking_wait");
+
+        std::cout << "Wait strategy tests passed\n";
+    }
+
+    void run_tests()
+    {
+        test_circular_buffer_batches();
+        test_circular_buffer_storage();
+        test_mirrored_byte_buffer();
+        test_shm_circular_buffer();
+        test_windowed_aggregate();
+        test_spsc_circular_buffer();
+        test_mpmc_circular_buffer();
+        test_wait_strategies();
+    }
+}
+
+namespace exercise_bench
+{
+    using namespace exercise;
+    using clock_type = std::chrono::steady_clock;
+
+    // Spins for a short while, then yields, so the benchmarks still make
+    // progress when both threads share a core.
+    template <typename Try>
+    void spin_until(Try&& attempt)
+    {
+        for (int spins = 0; !attempt(); ++spins)
+        {
+            if (spins < 64)
+            {
+                cpu_relax();
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // The baseline the lock-free ring replaces: the plain ring behind a mutex.
+    template <typename T, size_t S>
+    class mutex_circular_buffer
+    {
+        std::mutex mutex_;
+        circular_buffer<T, S> buffer_;
+
+    public:
+        bool push(const T& value)
+        {
+            std::lock_guard lock(mutex_);
+            if (buffer_.is_full())
+            {
+                return false;
+            }
+            buffer_.push(value);
+            return true;
+        }
+
+        bool pop(T& value)
+        {
+            std::lock_guard lock(mutex_);
+            if (buffer_.is_empty())
+            {
+                return false;
+            }
+            value = buffer_.pop();
+            return true;
+        }
+    };
+
+    // One producer streams count values to one consumer.
+    template <typename Ring>
+    double throughput_ns_per_item(size_t count)
+    {
+        auto ring = std::make_unique<Ring>();
+        auto const start = clock_type::now();
+
+        std::thread producer([&] {
+            for (size_t i = 0; i < count; ++i)
+            {
+                spin_until([&] { return ring->push(i); });
+            }
+        });
+
+        size_t value = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            spin_until([&] { return ring->pop(value); });
+        }
+        producer.join();
+
+        std::chrono::duration<double, std::nano> const elapsed = clock_type::now() - start;
+        return elapsed.count() / count;
+    }
+
+    // Ping-pong over two rings; half a round trip is one handoff.
+    template <typename Ring>
+    double handoff_latency_ns(size_t rounds)
+    {
+        auto ping = std::make_unique<Ring>();
+        auto pong = std::make_unique<Ring>();
+
+        std::thread echo([&] {
+            size_t value = 0;
+            for (size_t i = 0; i < rounds; ++i)
+            {
+                spin_until([&] { return ping->pop(value); });
+                spin_until([&] { return pong->push(value); });
+            }
+        });
+
+        auto const start = clock_type::now();
+        size_t value = 0;
+        for (size_t i = 0; i < rounds; ++i)
+        {
+            spin_until([&] { return ping->push(i); });
+            spin_until([&] { return pong->pop(value); });
+        }
+        std::chrono::duration<double, std::nano> const elapsed = clock_type::now() - start;
+        echo.join();
+
+        return elapsed.count() / rounds / 2;
+    }
+
+    void bench_spsc()
+    {
+        constexpr size_t items = 10'000'000;
+        constexpr size_t rounds = 200'000;
+
+        std::cout << "\n--- SPSC handoff (" << std::thread::hardware_concurrency() << " hardware threads) ---\n";
+        std::cout << "spsc_circular_buffer  throughput: " << throughput_ns_per_item<spsc_circular_buffer<size_t, 1024>>(items)
+                  << " ns/item, latency: " << handoff_latency_ns<spsc_circular_buffer<size_t, 1024>>(rounds) << " ns\n";
+        std::cout << "mutex_circular_buffer throughput: " << throughput_ns_per_item<mutex_circular_buffer<size_t, 1024>>(items)
+                  << " ns/item, latency: " << handoff_latency_ns<mutex_circular_buffer<size_t, 1024>>(rounds) << " ns\n";
+    }
+
+    // Producers and consumers split count items between them.
+    template <typename Ring>
+    double mpmc_throughput_mops(size_t producers, size_t consumers, size_t count)
+    {
+        auto ring = std::make_unique<Ring>();
+        std::atomic<size_t> consumed{0};
+        std::vector<std::thread> threads;
+        size_t const per_producer = count / producers;
+        size_t const total = per_producer * producers;
+
+        auto const start = clock_type::now();
+        for (size_t p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&] {
+                for (size_t i = 0; i < per_producer; ++i)
+                {
+                    spin_until([&] { return ring->push(i); });
+                }
+            });
+        }
+
+        for (size_t c = 0; c < consumers; ++c)
+        {
+            threads.emplace_back([&] {
+                size_t value = 0;
+                while (consumed.load(std::memory_order_relaxed) < total)
+                {
+                    if (ring->pop(value))
+                    {
+                        consumed.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    else
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        std::chrono::duration<double, std::micro> const elapsed = clock_type::now() - start;
+        return total / elapsed.count();
+    }
+
+    void bench_mpmc()
+    {
+        constexpr size_t items = 2'000'000;
+        size_t const max_threads = std::max<size_t>(4, std::thread::hardware_concurrency());
+
+        std::cout << "\n--- MPMC scaling, million items/s (producers x consumers) ---\n";
+        for (size_t threads = 1; threads <= max_threads; threads *= 2)
+        {
+            std::cout << threads << "x" << threads
+                      << "  lock-free: " << mpmc_throughput_mops<mpmc_circular_buffer<size_t, 1024>>(threads, threads, items)
+                      << "  mutex: " << mpmc_throughput_mops<mutex_circular_buffer<size_t, 1024>>(threads, threads, items) << "\n";
+        }
+    }
+
+    // Streams items through a ring in chunks: per element, via push_n/pop_n,
+    // and consuming in place through readable_segments.
+    void bench_batches()
+    {
+        constexpr size_t ring_size = 4096;
+        constexpr size_t chunk = 1024;
+        constexpr size_t rounds = 100'000;
+        using ring_type = circular_buffer<int, ring_size>;
+
+        auto ring = std::make_unique<ring_type>();
+        std::vector<int> input(chunk);
+        std::vector<int> output(chunk);
+        std::iota(input.begin(), input.end(), 0);
+        long long checksum = 0;
+
+        auto run = [&](char const* label, auto&& round) {
+            auto const start = clock_type::now();
+            for (size_t r = 0; r < rounds; ++r)
+            {
+                round();
+            }
+            std::chrono::duration<double, std::nano> const elapsed = clock_type::now() - start;
+            std::cout << label << elapsed.count() / (rounds * chunk) << " ns/element\n";
+        };
+
+        std::cout << "\n--- Batch transfer, " << chunk << " elements per round ---\n";
+        run("push/pop loop:       ", [&] {
+            for (int value : input)
+            {
+                ring->push(value);
+            }
+            for (size_t i = 0; i < chunk; ++i)
+            {
+                output[i] = ring->pop();
+            }
+            checksum += output[chunk - 1];
+        });
+        run("push_n/pop_n:        ", [&] {
+            ring->push_n(input);
+            ring->pop_n(output);
+            checksum += output[chunk - 1];
+        });
+        run("push_n + segments:   ", [&] {
+            ring->push_n(input);
+            auto const segments = ring->readable_segments();
+            checksum = std::accumulate(segments.first.begin(), segments.first.end(), checksum);
+            checksum = std::accumulate(segments.second.begin(), segments.second.end(), checksum);
+            ring->consume(segments.size());
+        });
+        std::cout << "(checksum " << checksum << ")\n";
+    }
+
+    // Variable-length records (a 32-bit length followed by the payload)
+    // streamed through a 1 MiB ring in bursts. The mirrored ring reads every
+    // record in place; the circular_buffer reader has to copy any record that
+    // straddles the wrap into a scratch buffer first.
+    void bench_variable_records()
+    {
+        constexpr size_t ring_bytes = 1 << 20;
+        constexpr size_t records = 5'000'000;
+        constexpr size_t burst = 256;
+
+        std::vector<uint32_t> lengths(4096);
+        uint32_t seed = 12345;
+        for (auto& length : lengths)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            length = 16 + (seed >> 8) % 497;
+        }
+        std::vector<std::byte> payload(512, std::byte{0x5a});
+
+        auto report = [](char const* label, clock_type::time_point start, size_t bytes, uint64_t checksum) {
+            std::chrono::duration<double> const elapsed = clock_type::now() - start;
+            std::cout << label << records / elapsed.count() / 1e6 << " M records/s, "
+                      << bytes / elapsed.count() / 1e9 << " GB/s (checksum " << checksum << ")\n";
+        };
+
+        std::cout << "\n--- Variable-length records through a 1 MiB ring ---\n";
+
+        {
+            mirrored_byte_buffer ring(ring_bytes);
+            uint64_t checksum = 0;
+            size_t bytes = 0;
+            auto const start = clock_type::now();
+            for (size_t produced = 0, consumed = 0; consumed < records;)
+            {
+                for (size_t i = 0; i < burst && produced < records; ++i, ++produced)
+                {
+                    uint32_t const length = lengths[produced % lengths.size()];
+                    auto const space = ring.writable();
+                    if (space.size() < sizeof(length) + length)
+                    {
+                        break;
+                    }
+                    std::memcpy(space.data(), &length, sizeof(length));
+                    std::memcpy(space.data() + sizeof(length), payload.data(), length);
+                    ring.commit(sizeof(length) + length);
+                }
+
+                auto readable = ring.readable();
+                while (!readable.empty())
+                {
+                    uint32_t length;
+                    std::memcpy(&length, readable.data(), sizeof(length));
+                    checksum += length + static_cast<uint8_t>(readable[sizeof(length) + length - 1]);
+                    bytes += sizeof(length) + length;
+                    readable = readable.subspan(sizeof(length) + length);
+                    ring.consume(sizeof(length) + length);
+                    ++consumed;
+                }
+            }
+            report("mirrored_byte_buffer: ", start, bytes, checksum);
+        }
+
+        {
+            auto ring = std::make_unique<circular_buffer<std::byte, ring_bytes>>();
+            std::vector<std::byte> scratch(sizeof(uint32_t) + payload.size());
+            std::vector<std::byte> staged(sizeof(uint32_t) + payload.size());
+            uint64_t checksum = 0;
+            size_t bytes = 0;
+            auto const start = clock_type::now();
+            for (size_t produced = 0, consumed = 0; consumed < records;)
+            {
+                for (size_t i = 0; i < burst && produced < records; ++i, ++produced)
+                {
+                    uint32_t const length = lengths[produced % lengths.size()];
+                    if (ring_bytes - ring->size() < sizeof(length) + length)
+                    {
+                        break;
+                    }
+                    std::memcpy(staged.data(), &length, sizeof(length));
+                    std::memcpy(staged.data() + sizeof(length), payload.data(), length);
+                    ring->push_n(std::span(staged).first(sizeof(length) + length));
+                }
+
+                while (!ring->is_empty())
+                {
+                    uint32_t length;
+                    std::byte prefix[sizeof(length)];
+                    for (size_t i = 0; i < sizeof(length); ++i)
+                    {
+                        prefix[i] = (*ring)[i];
+                    }
+                    std::memcpy(&length, prefix, sizeof(length));
+                    size_t const record_size = sizeof(length) + length;
+
+                    auto const segments = ring->readable_segments();
+                    bool const wrapped = segments.first.size() < record_size;
+                    if (wrapped)
+                    {
+                        ring->pop_n(std::span(scratch).first(record_size));
+                    }
+
+                    std::byte const* record = wrapped ? scratch.data() : segments.first.data();
+                    checksum += length + static_cast<uint8_t>(record[record_size - 1]);
+                    bytes += record_size;
+                    ++consumed;
+
+                    if (!wrapped)
+                    {
+                        ring->consume(record_size);
+                    }
+                }
+            }
+            report("copy-on-wrap ring:    ", start, bytes, checksum);
+        }
+    }
+
+    struct timestamped_message
+    {
+        uint64_t sequence;
+        int64_t sent_ns;
+        char payload[48];
+    };
+
+    int64_t monotonic_ns()
+    {
+        timespec now{};
+        ::clock_gettime(CLOCK_MONOTONIC, &now);
+        return static_cast<int64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+    }
+
+    // A forked producer process sends messages stamped with CLOCK_MONOTONIC
+    // to this process. The first run streams as fast as possible; the second
+    // sends one message at a time so the latency includes a futex wake-up.
+    void bench_shm_channel()
+    {
+        using channel = shm_circular_buffer<timestamped_message, 4096>;
+        std::string const name = "/test5_shm_bench." + std::to_string(::getpid());
+
+        auto run = [&](char const* label, size_t count, bool one_at_a_time) {
+            channel::unlink(name);
+            channel consumer(name, shm_role::consumer);
+
+            pid_t const child = ::fork();
+            if (child == 0)
+            {
+                channel producer(name, shm_role::producer);
+                timestamped_message message{};
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    if (one_at_a_time)
+                    {
+                        while (!producer.is_empty())
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                    message.sequence = i;
+                    message.sent_ns = monotonic_ns();
+                    producer.push_wait(message, std::chrono::seconds(10));
+                }
+                ::_exit(0);
+            }
+
+            // Until the child has attached, peer_alive() cannot tell a slow
+            // start from an exit.
+            auto const attach_deadline = clock_type::now() + std::chrono::seconds(10);
+            while (!consumer.peer_alive() && consumer.is_empty())
+            {
+                if (clock_type::now() > attach_deadline)
+                {
+                    ::kill(child, SIGKILL);
+                    ::waitpid(child, nullptr, 0);
+                    channel::unlink(name);
+                    std::cout << label << "producer never attached\n";
+                    return;
+                }
+                std::this_thread::yield();
+            }
+
+            std::vector<int64_t> latencies;
+            latencies.reserve(count);
+            timestamped_message message{};
+            auto const start = clock_type::now();
+            while (latencies.size() < count)
+            {
+                if (!consumer.pop_wait(message, std::chrono::milliseconds(100)))
+                {
+                    if (consumer.peer_alive())
+                    {
+                        continue;
+                    }
+                    // The producer left; take anything it pushed just before exiting.
+                    if (!consumer.pop(message))
+                    {
+                        break;
+                    }
+                }
+                latencies.push_back(monotonic_ns() - message.sent_ns);
+            }
+            std::chrono::duration<double> const elapsed = clock_type::now() - start;
+            ::waitpid(child, nullptr, 0);
+            channel::unlink(name);
+
+            if (latencies.empty())
+            {
+                std::cout << label << "no messages received\n";
+                return;
+            }
+            std::sort(latencies.begin(), latencies.end());
+            std::cout << label;
+            if (latencies.size() < count)
+            {
+                std::cout << "producer exited after " << latencies.size() << " of " << count << " messages, ";
+            }
+            std::cout << latencies.size() / elapsed.count() / 1e6 << " M msgs/s, p50 "
+                      << latencies[latencies.size() / 2] << " ns, p99 " << latencies[latencies.size() * 99 / 100] << " ns\n";
+        };
+
+        std::cout << "\n--- Shared-memory channel between two processes (64-byte messages) ---\n";
+        run("streaming:     ", 5'000'000, false);
+        run("one at a time: ", 100'000, true);
+    }
+
+    // Per-push cost of keeping sum/mean/variance/min/max current, against
+    // walking operator[] over the window after every push.
+    template <size_t S>
+    void bench_window_size(std::vector<double> const& samples)
+    {
+        auto window = std::make_unique<windowed_aggregate<double, S>>();
+        double sink = 0.0;
+        auto start = clock_type::now();
+        for (double sample : samples)
+        {
+            window->push(sample);
+            sink += window->sum() + window->min() + window->max() + window->variance();
+        }
+        std::chrono::duration<double, std::nano> incremental = clock_type::now() - start;
+
+        auto ring = std::make_unique<circular_buffer<double, S>>();
+        ring->push_n(std::span(samples).first(S));
+        size_t const walks = std::min<size_t>(samples.size(), 200'000'000 / S);
+        start = clock_type::now();
+        for (size_t i = 0; i < walks; ++i)
+        {
+            ring->push(samples[i]);
+            double sum = 0.0;
+            double low = (*ring)[0];
+            double high = (*ring)[0];
+            for (size_t j = 0; j < ring->size(); ++j)
+            {
+                sum += (*ring)[j];
+                low = std::min(low, (*ring)[j]);
+                high = std::max(high, (*ring)[j]);
+            }
+            double const mean = sum / ring->size();
+            double squares = 0.0;
+            for (size_t j = 0; j < ring->size(); ++j)
+            {
+                squares += ((*ring)[j] - mean) * ((*ring)[j] - mean);
+            }
+            sink += sum + low + high + squares;
+        }
+        std::chrono::duration<double, std::nano> walking = clock_type::now() - start;
+
+        start = clock_type::now();
+        window->resync();
+        std::chrono::duration<double, std::nano> resync = clock_type::now() - start;
+
+        std::cout << "S = " << S << ": incremental " << incremental.count() / samples.size()
+                  << " ns/push, walk " << walking.count() / walks << " ns/push, resync "
+                  << resync.count() / S << " ns/element (checksum " << sink << ")\n";
+    }
+
+    void bench_windowed_aggregate()
+    {
+        std::mt19937 generator(11);
+        std::normal_distribution<double> reals(100.0, 15.0);
+        std::vector<double> samples(4'000'000);
+        for (auto& sample : samples)
+        {
+            sample = reals(generator);
+        }
+
+        std::cout << "\n--- Sliding-window aggregates ---\n";
+        bench_window_size<64>(samples);
+        bench_window_size<1024>(samples);
+        bench_window_size<16384>(samples);
+        bench_window_size<262144>(samples);
+    }
+
+    double thread_cpu_seconds()
+    {
+        timespec now{};
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return now.tv_sec + now.tv_nsec / 1e9;
+    }
+
+    // A producer sends timestamped values at a fixed interval; the consumer
+    // sits in pop_wait. Reports handoff latency and how much of a core the
+    // idle consumer burns under each wait strategy.
+    template <typename Wait>
+    void bench_wait_strategy(char const* label, std::chrono::microseconds interval, size_t count)
+    {
+        auto ring = std::make_unique<spsc_circular_buffer<int64_t, 1024, Wait>>();
+        std::vector<int64_t> latencies;
+        latencies.reserve(count);
+        double consumer_cpu = 0.0;
+
+        auto const start = clock_type::now();
+        std::thread consumer([&] {
+            double const cpu_start = thread_cpu_seconds();
+            int64_t sent = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                ring->pop_wait(sent);
+                latencies.push_back(monotonic_ns() - sent);
+            }
+            consumer_cpu = thread_cpu_seconds() - cpu_start;
+        });
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto const due = start + interval * (i + 1);
+            while (clock_type::now() < due)
+            {
+                std::this_thread::sleep_until(due);
+            }
+            spin_until([&] { return ring->push(monotonic_ns()); });
+        }
+        consumer.join();
+        std::chrono::duration<double> const elapsed = clock_type::now() - start;
+
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << label << interval.count() << " us: p50 " << latencies[count / 2] << " ns, p99 "
+                  << latencies[count * 99 / 100] << " ns, consumer CPU " << 100.0 * consumer_cpu / elapsed.count() << "%\n";
+    }
+
+    void bench_wait_strategies()
+    {
+        std::cout << "\n--- Wait strategies: latency vs consumer CPU ---\n";
+        for (auto const interval : {std::chrono::microseconds(10), std::chrono::microseconds(100), std::chrono::microseconds(1000)})
+        {
+            size_t const count = std::min<size_t>(20000, 2'000'000 / interval.count());
+            bench_wait_strategy<busy_spin_wait>("busy_spin_wait  every ", interval, count);
+            bench_wait_strategy<spin_yield_wait>("spin_yield_wait every ", interval, count);
+            bench_wait_strategy<blocking_wait>("blocking_wait   every ", interval, count);
+        }
+    }
+
+    void run_benchmarks()
+    {
+        bench_wait_strategies();
+        bench_windowed_aggregate();
+        bench_shm_channel();
+        bench_variable_records();
+        bench_batches();
+        bench_spsc();
+        bench_mpmc();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace exercise;
+
+    circular_buffer<int, 5> buffer;
+
+    buffer.push(1);
+    buffer.push(2);
+    buffer.push(3);
+
+    std::cout << "Buffer size: " << buffer.size() << "\n";
+    std::cout << "Is buffer full? " << std::boolalpha << buffer.is_full() << "\n";
+
+    buffer.push(4);
+    buffer.push(5);
+    buffer.push(6); // This should overwrite the first element (1)
+
+    std::cout << "Buffer size after pushing 6 elements: " << buffer.size() << "\n";
+    std::cout << "Is buffer full? " << std::boolalpha << buffer.is_full() << "\n";
+    std::cout << "Element at index 0: " << buffer[0] << "\n"; // Should be 2
+
+    exercise_tests::run_tests();
+
+    if (argc > 1 && std::string(argv[1]) == "--bench")
+    {
+        exercise_bench::run_benchmarks();
+    }
 
     return 0;
 }
\ No newline at end of file